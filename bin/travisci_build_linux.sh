@@ -20,6 +20,33 @@ export LDFLAGS=$OPENMPFLAGS
 export LIBINT_NUM_THREADS=2
 
 ./autogen.sh
+
+# configures, builds, and checks a variant of the library in directory $1,
+# out of the source tree, hence before the source tree is configured;
+# the remaining arguments are passed to configure
+check_variant() {
+    dir=$1
+    shift
+    mkdir $dir
+    cd $dir
+    ../configure CPPFLAGS='-I/usr/include/eigen3' "$@"
+    make -j2
+    make check
+    cd ..
+    rm -rf $dir
+}
+
+# generic code above the optimized angular momentum, scalar
+check_variant build_generic --with-max-am=2 --with-opt-am=1 --enable-eri=0 --enable-1body=0 --enable-generic-code
+
+# generic code above the optimized angular momentum, vectorized over Cartesian
+# components
+check_variant build_simd_cart --with-max-am=2 --with-opt-am=1 --enable-eri=0 --enable-1body=0 --enable-generic-code --enable-simd-cart
+
+# second derivatives of 2-, 3-, and 4-center ERIs, e.g. for the engine tests
+# of Engine::set_unique_derivatives()
+check_variant build_deriv2 --with-max-am=1 --enable-eri=2 --enable-eri3=2 --enable-eri2=2 --enable-1body=0
+
 ./configure CPPFLAGS='-I/usr/include/eigen3' --with-max-am=2,2 --with-eri-max-am=2,2 --with-eri3-max-am=3,2 --enable-eri=1 --enable-eri3=1 --enable-1body=1 --disable-1body-property-derivs --with-multipole-max-order=2
 make -j2
 make check
@@ -44,7 +44,10 @@
 #endif
 
 #include <libint2/boys_fwd.h>
+#include <libint2/util/mapped_table.h>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #if HAVE_LAPACK // use F77-type interface for now, switch to LAPACKE later
 extern "C" void dgesv_(const int* n,
@@ -55,6 +58,62 @@ extern "C" void dgesv_(const int* n,
 
 namespace libint2 {
 
+  namespace detail {
+    /// CoreEvalInstance manages the instance of core evaluator \c CoreEval
+    /// shared by all Engine objects.
+
+    /// The instance is published atomically, hence get() does not lock if the
+    /// current instance can serve the request. Otherwise a new instance is
+    /// built under a lock; it serves the request as well as all requests served
+    /// before (i.e. the max m and the precision only grow), so that
+    /// concurrent and interleaved requests do not rebuild the tables repeatedly.
+    /// The old instance is released when its last user is destroyed.
+    template <typename CoreEval>
+    class CoreEvalInstance {
+      public:
+        typedef std::shared_ptr<CoreEval> pointer;
+
+        /// @return an instance that can compute for m in [0,mmax] with \c precision
+        static pointer get(int mmax, double precision) {
+          auto result = std::atomic_load(&instance_);
+          if (serves(result, mmax, precision))
+            return result;
+
+          std::lock_guard<std::mutex> lock(mutex_);
+          result = std::atomic_load(&instance_);  // may have been built meanwhile
+          if (serves(result, mmax, precision))
+            return result;
+          if (result) {
+            mmax = std::max(mmax, int(result->max_m()));
+            precision = std::min(precision, double(precision_of(*result, 0)));
+          }
+          result = std::make_shared<CoreEval>(mmax, precision);
+          std::atomic_store(&instance_, result);
+          return result;
+        }
+
+      private:
+        static bool serves(const pointer& instance, int mmax, double precision) {
+          return instance && instance->max_m() >= mmax &&
+                 precision_of(*instance, 0) <= precision;
+        }
+        // evaluators without precision() are exact as far as the requests are concerned
+        template <typename E>
+        static auto precision_of(const E& e, int) -> decltype(e.precision()) {
+          return e.precision();
+        }
+        template <typename E>
+        static double precision_of(const E&, long) { return 0.0; }
+
+        static pointer instance_;
+        static std::mutex mutex_;
+    };
+    template <typename CoreEval>
+    std::shared_ptr<CoreEval> CoreEvalInstance<CoreEval>::instance_;
+    template <typename CoreEval>
+    std::mutex CoreEvalInstance<CoreEval>::mutex_;
+  }  // namespace detail
+
   /// holds tables of expensive quantities
   template<typename Real>
   class ExpensiveNumbers {
@@ -251,6 +310,10 @@ namespace libint2 {
       int mmax;                   //!< the maximum m that is tabulated
       ExpensiveNumbers<double> numbers_;
       Real *c; /* the Chebyshev coefficients table, N by mmax*interpolation_order */
+      int nintervals_;  //!< N, the number of intervals in the table
+      std::unique_ptr<const detail::MappedTable> table_;  //!< if not null, c points to its data
+
+      static const uint32_t table_kind = 7;  //!< identifies the table files
 
     public:
       /// \param m_max maximum value of the Boys function index; set to -1 to skip initialization
@@ -263,28 +326,50 @@ namespace libint2 {
           init();
       }
       ~FmEval_Chebyshev7() {
-        if (mmax >= 0) {
+        if (mmax >= 0 && !table_) {
           free(c);
         }
       }
 
       /// Singleton interface allows to manage the lone instance; adjusts max m values as needed in thread-safe fashion
       static std::shared_ptr<const FmEval_Chebyshev7> instance(int m_max, double = 0.0) {
+        return detail::CoreEvalInstance<const FmEval_Chebyshev7>::get(m_max, 0.0);
+      }
 
-        // thread-safe per C++11 standard [6.7.4]
-        static auto instance_ = std::shared_ptr<const FmEval_Chebyshev7>{};
+      /// @return the maximum value of m for which the Boys function can be computed with this object
+      int max_m() const { return mmax; }
 
-        const bool need_new_instance = !instance_ || (instance_ && instance_->max_m() < m_max);
-        if (need_new_instance) {
-          auto new_instance = std::make_shared<const FmEval_Chebyshev7>(m_max);
-          instance_ = new_instance; // thread-safe
-        }
+      /// @return true if the interpolation table is mapped from a file
+      bool mapped() const { return static_cast<bool>(table_); }
 
-        return instance_;
+      /// @return the name of the table file that is mapped by the constructor
+      ///         if LIBINT_BOYS_TABLE_PATH environmental variable is set,
+      ///         or empty string otherwise
+      static std::string table_filename() {
+        const auto path = detail::MappedTable::path();
+        return path.empty() ? path : path + "/boys_cheb7.bin";
       }
 
-      /// @return the maximum value of m for which the Boys function can be computed with this object
-      int max_m() const { return mmax; }
+      /// writes the interpolation table to file \c filename (by default,
+      /// table_filename() ), so that it can be mapped by the objects
+      /// constructed (by this and other processes) with up to max_m() .
+      /// @return true if the file was written successfully
+      bool save_table(std::string filename = table_filename()) const {
+        if (filename.empty() || mmax < 0 ||
+            !std::is_same<Real, double>::value)
+          return false;
+        detail::MappedTable::header_type hdr;
+        std::memset(&hdr, 0, sizeof(hdr));
+        hdr.kind = table_kind;
+        hdr.mmax = mmax;
+        hdr.order = ORDER;
+        hdr.params[0] = delta;
+        hdr.params[1] = T_crit;
+        hdr.params[2] = nintervals_;
+        return detail::MappedTable::write(
+            filename, hdr, reinterpret_cast<const double*>(c),
+            (mmax + 1) * nintervals_ * ORDERp1);
+      }
 
       /// fills in Fm with computed Boys function values for m in [0,mmax]
       /// @param[out] Fm array to be filled in with the Boys function values, must be at least mmax+1 elements long
@@ -411,6 +496,23 @@ namespace libint2 {
         delta = cheb_table_delta;
         one_over_delta = 1 / delta;
         const int N = cheb_table_nintervals;
+        nintervals_ = N;
+
+        // use the prebuilt table, if available and compatible
+        if (std::is_same<Real, double>::value && !table_filename().empty()) {
+          table_ = detail::MappedTable::open(table_filename(), table_kind);
+          if (table_) {
+            const auto& hdr = table_->header();
+            if (hdr.mmax >= mmax && hdr.order == ORDER &&
+                hdr.params[0] == delta && hdr.params[1] == T_crit &&
+                hdr.params[2] == N) {
+              mmax = hdr.mmax;  // the table layout depends on its mmax
+              c = const_cast<Real*>(reinterpret_cast<const Real*>(table_->data()));
+              return;
+            }
+            table_.reset();
+          }
+        }
 
         // get memory
         void* result;
@@ -453,6 +555,10 @@ namespace libint2 {
 
         assert(mmax <= 63);
 
+        // use the prebuilt table, if available and compatible
+        if (map_table(mmax, precision))
+          return;
+
         const double sqrt_pi = std::sqrt(M_PI);
 
         /*---------------------------------------
@@ -533,27 +639,17 @@ namespace libint2 {
       }
 
       ~FmEval_Taylor() {
-        delete[] T_crit_;
-        delete[] grid_[0];
+        if (!table_) {
+          delete[] T_crit_;
+          delete[] grid_[0];
+        }
         delete[] grid_;
       }
 
       /// Singleton interface allows to manage the lone instance;
       /// adjusts max m and precision values as needed in thread-safe fashion
       static std::shared_ptr<const FmEval_Taylor> instance(unsigned int mmax, Real precision) {
-
-        // thread-safe per C++11 standard [6.7.4]
-        static auto instance_ = std::shared_ptr<const FmEval_Taylor>{};
-
-        const bool need_new_instance = !instance_ ||
-                                       (instance_ && (instance_->max_m() < mmax ||
-                                                      instance_->precision() > precision));
-        if (need_new_instance) {
-          auto new_instance = std::make_shared<const FmEval_Taylor>(mmax, precision);
-          instance_ = new_instance; // thread-safe
-        }
-
-        return instance_;
+        return detail::CoreEvalInstance<const FmEval_Taylor>::get(mmax, precision);
       }
 
       /// @return the maximum value of m for which this object can compute the Boys function
@@ -561,6 +657,44 @@ namespace libint2 {
       /// @return the precision with which this object can compute the Boys function
       Real precision() const { return cutoff_; }
 
+      /// @return true if the interpolation table is mapped from a file
+      bool mapped() const { return static_cast<bool>(table_); }
+
+      /// @return the name of the table file that is mapped by the constructor
+      ///         if LIBINT_BOYS_TABLE_PATH environmental variable is set,
+      ///         or empty string otherwise
+      static std::string table_filename() {
+        const auto path = detail::MappedTable::path();
+        return path.empty() ? path
+                            : path + "/boys_taylor" +
+                                  std::to_string(INTERPOLATION_ORDER) + ".bin";
+      }
+
+      /// writes the interpolation table to file \c filename (by default,
+      /// table_filename() ), so that it can be mapped by the objects
+      /// constructed (by this and other processes) with up to max_m() and
+      /// precision no tighter than precision() .
+      /// @return true if the file was written successfully
+      bool save_table(std::string filename = table_filename()) const {
+        if (filename.empty() || !std::is_same<Real, double>::value)
+          return false;
+        detail::MappedTable::header_type hdr;
+        std::memset(&hdr, 0, sizeof(hdr));
+        hdr.kind = table_kind;
+        hdr.mmax = max_m_;
+        hdr.order = INTERPOLATION_ORDER;
+        hdr.params[0] = cutoff_;
+        hdr.params[1] = delT_;
+        hdr.params[2] = max_T_;
+        // the grid, followed by T_crit_
+        const size_t grid_size = (max_T_ + 1) * (max_m_ + 1);
+        std::vector<double> data(grid_size + max_m_ + 1);
+        std::copy(grid_[0], grid_[0] + grid_size, data.begin());
+        std::copy(T_crit_, T_crit_ + max_m_ + 1, data.begin() + grid_size);
+        return detail::MappedTable::write(filename, hdr, data.data(),
+                                          data.size());
+      }
+
       /// computes Boys function values with m index in range [0,mmax]
       /// @param[out] Fm array to be filled in with the Boys function values, must be at least mmax+1 elements long
       /// @param[in] x the Boys function argument
@@ -719,6 +853,45 @@ namespace libint2 {
        for a given m and T_idx > max_T_idx[m] use the asymptotic formula */
 
       ExpensiveNumbers<double> numbers_;
+      std::unique_ptr<const detail::MappedTable> table_;  //!< if not null, grid_ and T_crit_ point to its data
+
+      static const uint32_t table_kind = 8;  //!< identifies the table files
+
+      /// maps the prebuilt table, if table_filename() is not empty and refers
+      /// to a valid table that supports at least \c mmax and \c precision
+      /// @return true if the table was mapped
+      bool map_table(unsigned int mmax, Real precision) {
+        if (!std::is_same<Real, double>::value || table_filename().empty())
+          return false;
+        table_ = detail::MappedTable::open(table_filename(), table_kind);
+        if (!table_)
+          return false;
+        const auto& hdr = table_->header();
+        const int max_m = hdr.mmax;
+        const int max_T = hdr.params[2];
+        if (hdr.order != INTERPOLATION_ORDER ||
+            max_m < int(mmax + INTERPOLATION_ORDER - 1) ||
+            hdr.params[0] > precision ||
+            hdr.size != size_t(max_T + 1) * (max_m + 1) + max_m + 1) {
+          table_.reset();
+          return false;
+        }
+
+        cutoff_ = hdr.params[0];
+        delT_ = hdr.params[1];
+        oodelT_ = 1.0 / delT_;
+        max_m_ = max_m;
+        max_T_ = max_T;
+        numbers_ = ExpensiveNumbers<double>(INTERPOLATION_ORDER + 1, 2 * max_m_);
+        const Real* data = reinterpret_cast<const Real*>(table_->data());
+        const int nrow = max_T_ + 1;
+        const int ncol = max_m_ + 1;
+        grid_ = new Real*[nrow];
+        for (int r = 0; r < nrow; ++r)
+          grid_[r] = const_cast<Real*>(data) + r * ncol;
+        T_crit_ = const_cast<Real*>(data) + nrow * ncol;
+        return true;
+      }
 
       /**
        * Power series estimate of the error introduced by replacing
@@ -1015,9 +1188,33 @@ namespace libint2 {
       CoreEvalScratch(CoreEvalScratch&&) = default;
       explicit CoreEvalScratch(int) { }
     };
+    /// the batched GaussianGmEval::eval keeps the per-geminal-term intermediates
+    /// for the whole batch, stored as structure of arrays
+    template <typename Real>
+    struct GaussianGmEvalBatchScratch {
+      std::vector<Real> ss_;      //!< (ss|g12|ss)
+      std::vector<Real> gorg_;    //!< gamma/(rho+gamma)
+      std::vector<Real> rorg_;    //!< rho/(rho+gamma)
+      std::vector<Real> oorhog_;  //!< 1/(rho+gamma)
+      void resize_batch(size_t n) {
+        if (ss_.size() < n) {
+          ss_.resize(n);
+          gorg_.resize(n);
+          rorg_.resize(n);
+          oorhog_.resize(n);
+        }
+      }
+    };
+    /// GaussianGmEval<Real,k> needs scratch for the batched evaluation
+    template <typename Real, int k>
+    struct CoreEvalScratch<GaussianGmEval<Real, k>> : public GaussianGmEvalBatchScratch<Real> {
+      CoreEvalScratch(const CoreEvalScratch&) = default;
+      CoreEvalScratch(CoreEvalScratch&&) = default;
+      explicit CoreEvalScratch(int) { }
+    };
     /// GaussianGmEval<Real,-1> needs extra scratch data
     template <typename Real>
-    struct CoreEvalScratch<GaussianGmEval<Real, -1>> {
+    struct CoreEvalScratch<GaussianGmEval<Real, -1>> : public GaussianGmEvalBatchScratch<Real> {
       std::vector<Real> Fm_;
       std::vector<Real> g_i;
       std::vector<Real> r_i;
@@ -1088,19 +1285,7 @@ namespace libint2 {
       /// Singleton interface allows to manage the lone instance;
       /// adjusts max m and precision values as needed in thread-safe fashion
       static std::shared_ptr<GaussianGmEval> instance(unsigned int mmax, Real precision) {
-
-        // thread-safe per C++11 standard [6.7.4]
-        static auto instance_ = std::shared_ptr<GaussianGmEval>{};
-
-        const bool need_new_instance = !instance_ ||
-                                       (instance_ && (instance_->max_m() < mmax ||
-                                                      instance_->precision() > precision));
-        if (need_new_instance) {
-          auto new_instance = std::make_shared<GaussianGmEval>(mmax, precision);
-          instance_ = new_instance; // thread-safe
-        }
-
-        return instance_;
+        return detail::CoreEvalInstance<GaussianGmEval>::get(mmax, precision);
       }
 
       /// @return the maximum value of m for which the \f$ G_m(\rho, T) \f$ can be computed with this object
@@ -1214,6 +1399,108 @@ namespace libint2 {
 
       }
 
+      /** computes \f$ G_m(\rho_q, T_q) \f$ for a batch of \c n pairs of \f$ \rho \f$ and \f$ T \f$ values,
+       * e.g. for all primitive quartets of a shell set. The geminal terms are processed in the outer loop,
+       * the batch in the inner (vectorizable) loops, hence the per-term intermediates are computed
+       * for the entire batch at once.
+       *
+       * @param[out] Gm array to be filled in with the \f$ Gm(\rho_q, T_q) \f$ values, \c Gm[q*(mmax+1)+m] ,
+       *                must be at least n*(mmax+1) elements long
+       * @param[in] rho array of \c n values of \f$ \rho \f$
+       * @param[in] T array of \c n values of \f$ T \f$
+       * @param[in] n the batch size
+       * @param[in] mmax mmax the maximum value of m for which Boys function will be computed;
+       *                 it must be <= the value returned by max_m() (this is not checked)
+       * @param[in] geminal the Gaussian geminal for which the core integral \f$ Gm(\rho, T) \f$ is computed
+       * @param[in] scr ptr to the per-thread \c libint2::detail::CoreEvalScratch<GaussianGmEval<Real,k>> object
+       */
+      template <typename AnyReal>
+      void eval(Real* Gm, const Real* rho, const Real* T, size_t n, size_t mmax,
+                const std::vector<std::pair<AnyReal, AnyReal> >& geminal,
+                void* scr) const {
+
+        auto& batch = *static_cast<detail::CoreEvalScratch<GaussianGmEval<Real, k>>*>(scr);
+        batch.resize_batch(n);
+        auto* ss = &batch.ss_[0];
+        auto* gorg = &batch.gorg_[0];
+        auto* rorg = &batch.rorg_[0];
+        auto* oorhog = &batch.oorhog_[0];
+
+        const auto mmax1 = mmax + 1;
+        std::fill(Gm, Gm + n * mmax1, Real(0));
+
+        for(const auto& g: geminal) {
+
+          const Real gamma = g.first;
+          const Real gcoef = g.second;
+
+          /// (ss|g12|ss) for the entire batch
+          constexpr Real const_SQRTPI_2(0.88622692545275801364908374167057259139877472806119); /* sqrt(pi)/2 */
+          for(size_t q=0; q!=n; ++q) {
+            const auto oorhog_q = 1 / (rho[q] + gamma);
+            gorg[q] = gamma * oorhog_q;
+            rorg[q] = rho[q] * oorhog_q;
+            oorhog[q] = oorhog_q;
+            ss[q] = gcoef * const_SQRTPI_2 * rorg[q] * sqrt(oorhog_q) * exp(-gorg[q] * T[q]);
+          }
+
+          if (k == -1) {
+            auto& scratch = *(reinterpret_cast<detail::CoreEvalScratch<GaussianGmEval<Real, -1>>*>(scr));
+            for(size_t i=1; i<=mmax; i++)
+              scratch.g_i[i] = scratch.g_i[i-1] * gamma;
+
+            constexpr Real const_2_SQRTPI(1.12837916709551257389615890312154517);   /* 2/sqrt(pi)     */
+            for(size_t q=0; q!=n; ++q) {
+              fm_eval_->eval(&scratch.Fm_[0], rorg[q] * T[q], mmax);
+              scratch.oorhog_i[0] = const_2_SQRTPI * ss[q] / sqrt(oorhog[q]);
+              for(size_t i=1; i<=mmax; i++) {
+                scratch.r_i[i] = scratch.r_i[i-1] * rho[q];
+                scratch.oorhog_i[i] = scratch.oorhog_i[i-1] * oorhog[q];
+              }
+              auto* Gm_q = Gm + q * mmax1;
+              for(size_t m=0; m<=mmax; m++) {
+                Real ssss = 0.0;
+                const Real* bcm = numbers_.bc[m];
+                for(size_t i=0; i<=m; i++) {
+                  ssss += bcm[i] * scratch.r_i[i] * scratch.g_i[m-i] * scratch.Fm_[i];
+                }
+                Gm_q[m] += ssss * scratch.oorhog_i[m];
+              }
+            }
+          }
+
+          if (k == 0) {
+            for(size_t q=0; q!=n; ++q) {
+              auto* Gm_q = Gm + q * mmax1;
+              auto ss_oper_ss_m = ss[q];
+              Gm_q[0] += ss_oper_ss_m;
+              for(size_t m=1; m<=mmax; ++m) {
+                ss_oper_ss_m *= gorg[q];
+                Gm_q[m] += ss_oper_ss_m;
+              }
+            }
+          }
+
+          if (k == 2) {
+            for(size_t q=0; q!=n; ++q) {
+              auto* Gm_q = Gm + q * mmax1;
+              /// (ss|g12*r12^2|ss)
+              const auto ss_oorhog = ss[q] * oorhog[q];
+              auto SS_K2G12_SS_gorg_m = (1.5 + rorg[q] * T[q]) * ss_oorhog;
+              auto SS_K2G12_SS_gorg_m1 = rorg[q] * ss_oorhog;
+              Gm_q[0] += SS_K2G12_SS_gorg_m;
+              for(size_t m=1; m<=mmax; ++m) {
+                SS_K2G12_SS_gorg_m *= gorg[q];
+                Gm_q[m] += SS_K2G12_SS_gorg_m - m * SS_K2G12_SS_gorg_m1;
+                SS_K2G12_SS_gorg_m1 *= gorg[q];
+              }
+            }
+          }
+
+        }
+
+      }
+
     private:
       int mmax_;
       Real precision_; //< absolute precision
@@ -1230,8 +1517,10 @@ namespace libint2 {
       GenericGmEval(int mmax, Real precision) : GmEvalFunction(mmax, precision),
           mmax_(mmax), precision_(precision) {}
 
+      /// Singleton interface allows to manage the lone instance;
+      /// adjusts max m and precision values as needed in thread-safe fashion
       static std::shared_ptr<const GenericGmEval> instance(int mmax, Real precision = 0.0) {
-        return std::make_shared<const GenericGmEval>(mmax, precision);
+        return detail::CoreEvalInstance<const GenericGmEval>::get(mmax, precision);
       }
 
       template <typename Real, typename... ExtraArgs>
@@ -1394,6 +1683,46 @@ namespace libint2 {
       std::shared_ptr<const FmEval_Taylor<Real>> fm_eval_;  // need for odd K
   };
 
+  /// core integral evaluator for the range-separated pair of kernels, \f$ 1 / r \f$
+  /// and \f$ \mathrm{erf}(\omega r) / r \f$ ; both sets of core integrals are computed
+  /// by a single call (the \f$ \mathrm{erfc}(\omega r) / r \f$ ones are their difference)
+  template <typename Real>
+  struct rs_coulomb_gm_eval {
+    typedef Real value_type;
+
+    rs_coulomb_gm_eval(unsigned int mmax, Real precision) {
+      fm_eval_ = FmEval_Taylor<Real>::instance(mmax, precision);
+      fm_eval_coulomb_ = FmEval_Chebyshev7<Real>::instance(mmax, precision);
+    }
+    /// computes the \f$ 1 / r \f$ core integrals into \c Gm and
+    /// the \f$ \mathrm{erf}(\omega r) / r \f$ ones into \c Gm_erf
+    void operator()(Real* Gm, Real rho, Real T, int mmax, Real omega,
+                    Real* Gm_erf) const {
+      // same evaluator as Operator::coulomb
+      fm_eval_coulomb_->eval(Gm, T, mmax);
+      if (omega > 0) {
+        auto omega2 = omega * omega;
+        auto omega2_over_omega2_plus_rho = omega2 / (omega2 + rho);
+        fm_eval_->eval(Gm_erf, T * omega2_over_omega2_plus_rho,
+                       mmax);
+
+        auto ooversqrto2prho_exp_2mplus1 =
+            std::sqrt(omega2_over_omega2_plus_rho);
+        for (auto m = 0; m <= mmax;
+             ++m, ooversqrto2prho_exp_2mplus1 *= omega2_over_omega2_plus_rho) {
+          Gm_erf[m] *= ooversqrto2prho_exp_2mplus1;
+        }
+      }
+      else {
+        std::fill(Gm_erf, Gm_erf+mmax+1, Real{0});
+      }
+    }
+
+     private:
+      std::shared_ptr<const FmEval_Taylor<Real>> fm_eval_;
+      std::shared_ptr<const FmEval_Chebyshev7<Real>> fm_eval_coulomb_;
+  };
+
   }  // namespace os_core_ints
 
   /*
@@ -52,6 +52,7 @@ namespace libint2 {
   template <typename Real, int K> struct r12_xx_K_gm_eval;
   template <typename Real> struct erf_coulomb_gm_eval;
   template <typename Real> struct erfc_coulomb_gm_eval;
+  template <typename Real> struct rs_coulomb_gm_eval;
   }  // namespace os_core_ints
 
   /*
@@ -27,6 +27,7 @@
 #endif
 
 #include <deque>
+#include <type_traits>
 
 #pragma GCC diagnostic push
 #pragma GCC system_header
@@ -82,6 +83,33 @@ namespace libint2 {
       y += a*x;
     }
 
+    /// the following allow to keep the DIIS history (see DIIS) in a lower
+    /// precision than the solution/error, e.g. as single-precision matrices
+
+    template <typename Derived1, typename Derived2>
+    auto
+    dot_product(const Eigen::MatrixBase<Derived1>& d1,
+                const Eigen::MatrixBase<Derived2>& d2)
+        -> decltype(typename Derived1::Scalar() * typename Derived2::Scalar()) {
+      typedef decltype(typename Derived1::Scalar() * typename Derived2::Scalar()) scalar_type;
+      return d1.template cast<scalar_type>().cwiseProduct(d2.template cast<scalar_type>()).sum();
+    }
+
+    template<typename _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols, typename Derived, typename Scalar>
+    void
+    axpy(Eigen::Matrix< _Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols >& y,
+         Scalar a,
+         const Eigen::MatrixBase<Derived>& x) {
+      y += a*x.template cast<_Scalar>();
+    }
+
+    template<typename _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols, typename Derived>
+    void
+    assign(Eigen::Matrix< _Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols >& s,
+           const Eigen::MatrixBase<Derived>& d) {
+      s = d.template cast<_Scalar>();
+    }
+
   }
 
   /// DIIS (``direct inversion of iterative subspace'') extrapolation
@@ -126,9 +154,21 @@ namespace libint2 {
   /// Note that the mixing is not used in the first iteration.
   /// \\
   /// The original DIIS reference: P. Pulay, Chem. Phys. Lett. 73, 393 (1980).
+  /// \\
+  /// For large problems the memory of DIIS is dominated by the history of
+  /// \f$ x \f$ and \f$ e \f$ (\f$ 2 \times \f$ \c ndiis objects of type \c D ).
+  /// The history can be kept in a more compact type \c S , e.g.
+  /// \c DIIS<Eigen::MatrixXd,Eigen::MatrixXf> halves the memory; the new
+  /// error is still used in full precision for the new row of \f$ B \f$,
+  /// and the extrapolated \f$ x \f$ is accumulated in \c D one history
+  /// element at a time.
   ///
   /// \tparam D type of \c x
-  template <typename D>
+  /// \tparam S type of the stored history of \c x and errors; if it differs
+  ///   from \c D , \c diis::assign(S&,const D&) ,
+  ///   \c diis::dot_product(const S&,const D&) , and
+  ///   \c diis::axpy(D&,value_type,const S&) must be defined
+  template <typename D, typename S = D>
   class DIIS {
     public:
       typedef typename diis::traits<D>::element_type value_type;
@@ -198,6 +238,7 @@ namespace libint2 {
         // if have ndiis vectors
         if (errors_.size() == ndiis) { // holding max # of vectors already? drop the least recent {x, error} pair
           x_.pop_front();
+          if (store_differences && not x_.empty()) x_.front() = S(); // no longer needed, see below
           errors_.pop_front();
           if (not x_extrap_.empty()) x_extrap_.pop_front();
           EigenMatrixX Bcrop = B_.bottomRightCorner(ndiis-1,ndiis-1);
@@ -206,20 +247,36 @@ namespace libint2 {
         }
 
         // push {x, error} to the set
-        x_.push_back(x);
-        errors_.push_back(error);
+        x_.emplace_back();
+        if (store_differences) {
+          if (x_.size() > 1) {
+            axpy(x_last_, -1.0, x);
+            store(x_.back(), x_last_);
+          }
+          x_last_ = x;
+        }
+        else
+          store(x_.back(), x);
+        errors_.emplace_back();
+        store(errors_.back(), error);
         const unsigned int nvec = errors_.size();
         assert(x_.size() == errors_.size());
 
         // and compute the most recent elements of B, B(i,j) = <ei|ej>
         for (unsigned int i=0; i < nvec-1; i++)
-          B_(i,nvec-1) = B_(nvec-1,i) = dot_product(errors_[i], errors_[nvec-1]);
-        B_(nvec-1,nvec-1) = dot_product(errors_[nvec-1], errors_[nvec-1]);
+          B_(i,nvec-1) = B_(nvec-1,i) = dot_product(errors_[i], error);
+        B_(nvec-1,nvec-1) = dot_product(error, error);
 
         if (iter == 1) { // the first iteration
           if (not x_extrap_.empty() && do_mixing) {
             zero(x);
-            axpy(x, (1.0-mixing_fraction), x_[0]);
+            if (store_differences) { // x_0 = x_last_ + \sum_{k>0} x_[k]
+              axpy(x, (1.0-mixing_fraction), x_last_);
+              for (unsigned int k=1; k < nvec; ++k)
+                axpy(x, (1.0-mixing_fraction), x_[k]);
+            }
+            else
+              axpy(x, (1.0-mixing_fraction), x_[0]);
             axpy(x, mixing_fraction, x_extrap_[0]);
           }
         }
@@ -282,7 +339,7 @@ namespace libint2 {
           }
           --nskip; // undo the last ++ :-(
 
-          {
+          if (not store_differences) {
 
             zero(x);
             for (unsigned int k=nskip, kk=1; k < nvec; ++k, ++kk) {
@@ -297,10 +354,32 @@ namespace libint2 {
               }
             }
           }
+          else {
+            // x_k = x_last_ + \sum_{j=k+1}^{nvec-1} x_[j] , hence
+            // \sum_k c_k x_k = (\sum_k c_k) x_last_ + \sum_j (\sum_{k<j} c_k) x_[j]
+            const bool mix = do_mixing && not x_extrap_.empty();
+            const value_type x_fraction = mix ? 1.0 - mixing_fraction : 1.0;
+            zero(x);
+            value_type csum = 0.0;
+            for (unsigned int k=nskip, kk=1; k < nvec; ++k, ++kk) {
+              if (k > nskip)
+                axpy(x, x_fraction * csum, x_[k]);
+              csum += c[kk];
+              if (not mix) {
+                if (extrapolate_error)
+                  axpy(error, c[kk], errors_[k]);
+              } else
+                axpy(x, c[kk] * mixing_fraction, x_extrap_[k]);
+            }
+            axpy(x, x_fraction * csum, x_last_);
+          }
         } // do DIIS
 
         // only need to keep extrapolated x if doing mixing
-        if (do_mixing) x_extrap_.push_back(x);
+        if (do_mixing) {
+          x_extrap_.emplace_back();
+          store(x_extrap_.back(), x);
+        }
       }
 
       /// calling this function forces the extrapolation to start upon next call
@@ -314,7 +393,10 @@ namespace libint2 {
         iter=0;
         if (data) {
           const bool do_mixing = (mixing_fraction != 0.0);
-          if (do_mixing) x_extrap_.push_front(*data);
+          if (do_mixing) {
+            x_extrap_.emplace_front();
+            store(x_extrap_.front(), *data);
+          }
         }
       }
 
@@ -335,9 +417,26 @@ namespace libint2 {
 
       EigenMatrixX B_; //!< B(i,j) = <ei|ej>
 
-      std::deque<D> x_; //!< set of most recent x given as input (i.e. not exrapolated)
-      std::deque<D> errors_; //!< set of most recent errors
-      std::deque<D> x_extrap_; //!< set of most recent extrapolated x
+      /// if the history is kept in a (less precise) type other than \c D ,
+      /// x_[k] holds x_{k-1} - x_k , which vanishes as the iterations converge,
+      /// rather than x_k , and the most recent x is kept in x_last_ ; this way
+      /// the precision of \c S limits only the precision of the (small) updates
+      static constexpr bool store_differences = !std::is_same<S, D>::value;
+      D x_last_; //!< the most recent x, if store_differences
+
+      std::deque<S> x_; //!< set of most recent x given as input (i.e. not exrapolated)
+      std::deque<S> errors_; //!< set of most recent errors
+      std::deque<S> x_extrap_; //!< set of most recent extrapolated x
+
+      /// copies \c d to the history element \c s , converting if needed
+      static void store(S& s, const D& d) {
+        store(s, d, std::is_same<S, D>());
+      }
+      static void store(S& s, const D& d, std::true_type) { s = d; }
+      static void store(S& s, const D& d, std::false_type) {
+        using ::libint2::diis::assign;
+        assign(s, d);
+      }
 
       void set_error(value_type e) { error_ = e; errorset_ = true; }
       value_type error() { return error_; }
@@ -350,6 +449,7 @@ namespace libint2 {
         x_.clear();
         errors_.clear();
         x_extrap_.clear();
+        x_last_ = D();
         //x_.resize(ndiis);
         //errors_.resize(ndiis);
         // x_extrap_ is bigger than the other because
@@ -53,13 +53,12 @@
 #include <libint2/util/intpart_iter.h>
 #include <libint2/util/compressed_pair.h>
 #include <libint2/util/timer.h>
+#include <libint2/util/profile.h>
 
 // the engine will be profiled by default if library was configured with
 // --enable-profile
 #ifdef LIBINT2_PROFILE
 #define LIBINT2_ENGINE_TIMERS
-// uncomment if want to profile each integral class
-#define LIBINT2_ENGINE_PROFILE_CLASS
 #endif
 // uncomment if want to profile the engine even if library was configured
 // without --enable-profile
@@ -81,6 +80,39 @@ constexpr size_t num_geometrical_derivatives(size_t ncenter,
              : 1;
 }
 
+/// maps the index of a geometrical derivative shell set w.r.t. the coordinates
+/// of \c ncenter centers (in the order produced by Engine) to its index in the
+/// translationally-unique set, i.e. the derivatives w.r.t. the first
+/// \c ncenter-1 centers only
+/// @return the index in the unique set, or -1 if shell set \c s involves the
+///         derivatives w.r.t. the last center
+/// @note only first and second derivatives are supported
+inline int unique_geometrical_derivative_index(size_t ncenter,
+                                               size_t deriv_order, size_t s) {
+  const auto ncoords = 3 * ncenter;
+  const auto ncoords_unique = ncoords - 3;
+  switch (deriv_order) {
+    case 0:
+      return s;
+    case 1:
+      return s < ncoords_unique ? s : -1;
+    case 2: {
+      // s indexes the upper triangle {i,j>=i}, row by row
+      size_t i = 0;
+      while (s >= ncoords - i) {
+        s -= ncoords - i;
+        ++i;
+      }
+      const auto j = i + s;
+      if (j >= ncoords_unique) return -1;
+      return i * ncoords_unique - i * (i - 1) / 2 + (j - i);
+    }
+    default:
+      assert(false && "3-rd and higher derivatives not yet generalized");
+  }
+  return -1;
+}
+
 template <typename T, unsigned N>
 __libint2_engine_inline typename std::remove_all_extents<T>::type* to_ptr1(T (&a)[N]);
 
@@ -146,13 +178,17 @@ enum class Operator {
   /// erfc-attenuated Coulomb operator,
   /// \f$ \mathrm{erfc}(\omega r)/r \f$
   erfc_coulomb,
+  /// range-separated Coulomb operator set, \f$ 1/r \f$ (full-range)
+  /// and \f$ \mathrm{erf}(\omega r)/r \f$ (long-range); both sets are
+  /// computed in one pass that shares the primitive data and screening
+  rs_coulomb,
   // do not modify this
   invalid = -1,
   // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!keep this updated!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
   first_1body_oper = overlap,
   last_1body_oper = sphemultipole,
   first_2body_oper = delta,
-  last_2body_oper = erfc_coulomb,
+  last_2body_oper = rs_coulomb,
   first_oper = first_1body_oper,
   last_oper = last_2body_oper
 };
@@ -319,6 +355,18 @@ struct operator_traits<Operator::erfc_coulomb>
   typedef const libint2::GenericGmEval<libint2::os_core_ints::erfc_coulomb_gm_eval<scalar_type>>
       core_eval_type;
 };
+template <>
+struct operator_traits<Operator::rs_coulomb>
+    : public detail::default_operator_traits {
+  /// the attenuation parameter of the long-range operator
+  typedef scalar_type oper_params_type;
+  static oper_params_type default_params() {
+    return oper_params_type{0};
+  }
+  static constexpr auto nopers = 2u;  //!< full-range + long-range
+  typedef const libint2::GenericGmEval<libint2::os_core_ints::rs_coulomb_gm_eval<scalar_type>>
+      core_eval_type;
+};
 
 /// the runtime version of \c operator_traits<oper>::default_params()
 libint2::any
@@ -426,7 +474,8 @@ class Engine {
         braket_(BraKet::invalid),
         primdata_(),
         stack_size_(0),
-        lmax_(-1) {
+        lmax_(-1),
+        unique_derivs_(false) {
     set_precision(std::numeric_limits<scalar_type>::epsilon());
   }
 
@@ -460,8 +509,12 @@ class Engine {
   ///               this is not needed.
   ///               \sa Engine::operator_traits
   /// \param braket a value of BraKet type
-  /// \warning currently only one-contraction Shell objects are supported; i.e.
-  /// generally-contracted Shells are not yet supported
+  /// \note generally-contracted Shell objects are supported; their integrals
+  /// are computed one contraction at a time, but for 2-body integrals the
+  /// primitive data (shell pairs and core integrals) are shared by all
+  /// contractions. Shell sets of generally-contracted shells are packed in
+  /// row-major order, with the functions of each Shell ordered as in
+  /// Shell::contr .
   // clang-format on
   template <typename Params = empty_pod>
   Engine(Operator oper, size_t max_nprim, int max_l, int deriv_order = 0,
@@ -475,6 +528,7 @@ class Engine {
         stack_size_(0),
         lmax_(max_l),
         deriv_order_(deriv_order),
+        unique_derivs_(false),
         params_(enforce_params_type(oper, params)) {
     set_precision(precision);
     initialize(max_nprim);
@@ -496,6 +550,7 @@ class Engine {
         lmax_(other.lmax_),
         hard_lmax_(other.hard_lmax_),
         deriv_order_(other.deriv_order_),
+        unique_derivs_(other.unique_derivs_),
         precision_(other.precision_),
         ln_precision_(other.ln_precision_),
         core_eval_pack_(std::move(other.core_eval_pack_)),
@@ -517,6 +572,7 @@ class Engine {
         stack_size_(other.stack_size_),
         lmax_(other.lmax_),
         deriv_order_(other.deriv_order_),
+        unique_derivs_(other.unique_derivs_),
         precision_(other.precision_),
         ln_precision_(other.ln_precision_),
         core_eval_pack_(other.core_eval_pack_),
@@ -538,6 +594,7 @@ class Engine {
     lmax_ = other.lmax_;
     hard_lmax_ = other.hard_lmax_;
     deriv_order_ = other.deriv_order_;
+    unique_derivs_ = other.unique_derivs_;
     precision_ = other.precision_;
     ln_precision_ = other.ln_precision_;
     core_eval_pack_ = std::move(other.core_eval_pack_);
@@ -561,6 +618,7 @@ class Engine {
     stack_size_ = other.stack_size_;
     lmax_ = other.lmax_;
     deriv_order_ = other.deriv_order_;
+    unique_derivs_ = other.unique_derivs_;
     precision_ = other.precision_;
     ln_precision_ = other.ln_precision_;
     core_eval_pack_ = other.core_eval_pack_;
@@ -570,6 +628,14 @@ class Engine {
     return *this;
   }
 
+  /// builds the core evaluator (e.g. the Boys function tables) that the
+  /// engines for operator \c oper with the default braket will share, so
+  /// that constructing such engines later (e.g. in worker threads) is cheap.
+  /// The parameters have the same meaning as in the constructor.
+  static __libint2_engine_inline void prewarm(
+      Operator oper, int max_l, int deriv_order = 0,
+      scalar_type precision = std::numeric_limits<scalar_type>::epsilon());
+
   /// returns the particle rank of the operator
   int operator_rank() const { return rank(oper_); }
 
@@ -593,6 +659,33 @@ class Engine {
     }
   }
 
+  /// requests that derivatives of 2-body integrals are reported only for
+  /// the translationally-unique set, i.e. w.r.t. the coordinates of the first
+  /// braket_rank()-1 centers. By translational invariance the derivatives
+  /// w.r.t. the last center are minus the sum of those w.r.t. the other
+  /// centers, e.g. for the second derivatives
+  /// \f$ \partial_{D} \partial_{D} = \sum_{c,c'} \partial_{c}
+  /// \partial_{c'} \f$ and \f$ \partial_{c} \partial_{D} = -\sum_{c'}
+  /// \partial_{c} \partial_{c'} \f$. This reduces the number of shell sets
+  /// to be transformed and returned by compute2() from 12 to 9 (first
+  /// derivatives of 4-center integrals) or from 78 to 45 (second derivatives).
+  /// Shell sets are ordered as for the full set, with the last center
+  /// omitted; \sa unique_geometrical_derivative_index()
+  /// \note ignored for 1-body integrals
+  Engine& set_unique_derivatives(bool flag) {
+    if (unique_derivs_ != flag) {
+      unique_derivs_ = flag;
+      if (lmax_ >= 0) {
+        init_targets();
+        reset_scratch();
+      }
+    }
+    return *this;
+  }
+  /// @return true if only the translationally-unique derivatives are computed
+  /// @sa set_unique_derivatives()
+  bool unique_derivatives() const { return unique_derivs_; }
+
   /// resets operator parameters; this may be useful e.g. if need to compute
   /// Coulomb potential
   /// integrals over batches of charges for the sake of parallelism.
@@ -625,13 +718,49 @@ class Engine {
   __libint2_engine_inline const target_ptr_vec& compute(
       const libint2::Shell& first_shell, const ShellPack&... rest_of_shells);
 
+  /// Computes target shell sets of integrals over shell views, like
+  /// compute(const Shell&, ...) .
+  /// \sa FlatBasisSet
+  template <typename... ShellPack>
+  __libint2_engine_inline const target_ptr_vec& compute(
+      const libint2::ShellView& first_shell,
+      const ShellPack&... rest_of_shells);
+
+  /// Computes target shell sets of integrals with compute() and copies them
+  /// to caller-provided storage with arbitrary strides.
+
+  /// This is a copy helper: the shell sets are computed into the engine's
+  /// internal storage, as by compute(), and then copied, hence it saves the
+  /// caller the scatter loop, not the copy. Integral {f1,f2,...} of shell set
+  /// \c s (the function indices refer to the shells in the order they are
+  /// given) is copied to <tt>dest[s][f1*strides[0] + f2*strides[1] + ...]</tt>
+  /// , after multiplication by \c scale ; if \c accumulate is true, it is
+  /// added to the value in \c dest instead. For example, to put a 1-body shell
+  /// set into the {bf1,bf2} block of a row-major matrix \c M with leading
+  /// dimension \c ld use <tt>dest[0] = M + bf1 * ld + bf2</tt> and
+  /// <tt>strides = {ld, 1}</tt>; to put it into the transposed block use
+  /// <tt>dest[0] = M + bf2 * ld + bf1</tt> and <tt>strides = {1, ld}</tt>.
+  /// @tparam ShellT Shell or ShellView
+  /// @param[in] dest pointers to the destinations of Engine::nshellsets()
+  ///            shell sets
+  /// @param[in] strides the stride of each shell's function index in \c dest
+  /// @return false if all integrals were screened out, in which case \c dest
+  ///         is not modified
+  template <typename ShellT, typename... ShellPack>
+  __libint2_engine_inline bool compute_and_copy(
+      value_type* const* dest, const std::array<size_t, 4>& strides,
+      value_type scale, bool accumulate, const ShellT& first_shell,
+      const ShellPack&... rest_of_shells);
+
   /// Computes target shell sets of 1-body integrals.
+  /// @tparam ShellT Shell or ShellView
   /// @param[in] s1
   /// @param[in] s2
   /// @return vector of pointers to target shell sets, the number of sets = Engine::nshellsets()
   /// \note resulting shell sets are stored in row-major order
-  __libint2_engine_inline const target_ptr_vec& compute1(
-      const libint2::Shell& s1, const libint2::Shell& s2);
+  template <typename ShellT>
+  __libint2_engine_inline const target_ptr_vec& compute1(const ShellT& s1,
+                                                         const ShellT& s2);
 
   /// Computes target shell sets of 2-body integrals, @code  @endcode
   /// @note result is stored in the "chemists"/Mulliken form, @code (bra1 bra2|ket1 ket2) @endcode;
@@ -640,6 +769,7 @@ class Engine {
   /// @tparam oper operator
   /// @tparam braket the integral type
   /// @tparam deriv_order the derivative order, values greater than 2 not yet supported
+  /// @tparam ShellT Shell or ShellView
   /// @param[in] bra1 the first shell in the Mulliken bra
   /// @param[in] bra2 the second shell in the Mulliken bra
   /// @param[in] ket1 the first shell in the Mulliken ket
@@ -654,20 +784,23 @@ class Engine {
   /// @note internally the integrals are evaluated with shells permuted to according to the canonical
   /// order predefined at the library generation time (see macro @c LIBINT_SHELL_SET ). To minimize the overhead it is recommended to
   /// organize your shell loop nests in the order best suited for your particular instance of Libint library.
-  template <Operator oper, BraKet braket, size_t deriv_order>
-  __libint2_engine_inline const target_ptr_vec& compute2(const Shell& bra1,
-                                                         const Shell& bra2,
-                                                         const Shell& ket1,
-                                                         const Shell& ket2,
+  template <Operator oper, BraKet braket, size_t deriv_order,
+            typename ShellT = Shell>
+  __libint2_engine_inline const target_ptr_vec& compute2(const ShellT& bra1,
+                                                         const ShellT& bra2,
+                                                         const ShellT& ket1,
+                                                         const ShellT& ket2,
                                                          const ShellPair* spbra = nullptr,
                                                          const ShellPair* spket = nullptr);
 
-  typedef const target_ptr_vec& (Engine::*compute2_ptr_type)(const Shell& bra1,
-                                                             const Shell& bra2,
-                                                             const Shell& ket1,
-                                                             const Shell& ket2,
-                                                             const ShellPair* spbra,
-                                                             const ShellPair* spket);
+  template <typename ShellT>
+  using compute2_ptr_t = const target_ptr_vec& (Engine::*)(const ShellT& bra1,
+                                                           const ShellT& bra2,
+                                                           const ShellT& ket1,
+                                                           const ShellT& ket2,
+                                                           const ShellPair* spbra,
+                                                           const ShellPair* spket);
+  typedef compute2_ptr_t<Shell> compute2_ptr_type;
 
   /** this specifies target precision for computing the integrals.
    *  target precision \f$ \epsilon \f$ is used in 3 ways:
@@ -707,16 +840,8 @@ class Engine {
     std::cout << "build timers: hrr = " << primdata_[0].timers->read(0)
               << " vrr = " << primdata_[0].timers->read(1) << std::endl;
 #endif
-#ifdef LIBINT2_ENGINE_TIMERS
-#ifdef LIBINT2_ENGINE_PROFILE_CLASS
-    for (const auto& p : class_profiles) {
-      printf("{\"%s\", %10.5lf, %10.5lf, %10.5lf, %10.5lf, %ld, %ld},\n",
-             p.first.to_string().c_str(), p.second.prereqs, p.second.build_vrr,
-             p.second.build_hrr, p.second.tform, p.second.nshellset,
-             p.second.nprimset);
-    }
-#endif
-#endif
+    // per-class statistics of all engines, see Profiler
+    if (Profiler::enabled()) Profiler::write_json(std::cout);
   }
 
   /// Exception class to be used when the angular momentum limit is exceeded.
@@ -755,6 +880,8 @@ class Engine {
   int lmax_;
   int hard_lmax_;  // max L supported by library for this operator type + 1
   int deriv_order_;
+  bool unique_derivs_;  // if true, compute2() skips the derivatives w.r.t. the
+                        // last center
   scalar_type precision_;
   scalar_type ln_precision_;
 
@@ -786,6 +913,46 @@ class Engine {
   typedef void (*buildfnptr_t)(const Libint_t*);
   buildfnptr_t* buildfnptrs_;
 
+  // scratch for generally-contracted shells, (re)built by every compute call
+  // that involves such shells, hence not copied/moved
+  /// one-contraction copies of each shell in the set
+  std::array<std::vector<Shell>, 4> gencon_shells_;
+  /// shell pair data shared by all contractions
+  ShellPair gencon_spbra_;
+  ShellPair gencon_spket_;
+  /// holds target shell sets of generally-contracted shells
+  std::vector<value_type> gencon_results_;
+  /// core integrals shared by all contractions of a shell set; indexed by the
+  /// primitive quartet, each has the room for \c mmax+1 values
+  struct gencon_core_ints_cache {
+    bool active = false;
+    int mmax = 0;
+    size_t npket = 0;  // # of primitive pairs in the (unpermuted) ket
+    std::vector<value_type> values;
+    std::vector<char> computed;
+  } gencon_cache_;
+  /// inputs and outputs of the batched evaluation of geminal core integrals,
+  /// indexed by the primitive quartet
+  struct geminal_core_ints_batch {
+    std::vector<value_type> rho;
+    std::vector<value_type> T;
+    std::vector<value_type> pfac;
+    std::vector<value_type> values;  // mmax+1 values per quartet
+    void resize(size_t nquartets, int mmax) {
+      if (rho.size() < nquartets) {
+        rho.resize(nquartets);
+        T.resize(nquartets);
+        pfac.resize(nquartets);
+      }
+      if (values.size() < nquartets * (mmax + 1))
+        values.resize(nquartets * (mmax + 1));
+    }
+  } geminal_batch_;
+  /// Operator::rs_coulomb: the long-range core integrals (mmax+1 per primitive
+  /// quartet) and the stack used to build the long-range shell sets
+  std::vector<value_type> rs_core_ints_;
+  std::vector<value_type> rs_stack_;
+
   /// reports the number of shell sets that each call to compute() produces.
   unsigned int compute_nshellsets() const {
     const unsigned int num_operator_geometrical_derivatives =
@@ -794,7 +961,9 @@ class Engine {
             ? this->nparams()
             : 0;
     const auto ncenters = braket_rank() + num_operator_geometrical_derivatives;
-    return nopers() * num_geometrical_derivatives(ncenters, deriv_order_);
+    const auto unique = unique_derivs_ && operator_rank() == 2;
+    return nopers() * num_geometrical_derivatives(unique ? ncenters - 1 : ncenters,
+                                                  deriv_order_);
   }
 
   void reset_scratch() {
@@ -818,20 +987,54 @@ class Engine {
                                          : primdata_[0].stack;
   }
 
+  /// computes 1-body shell sets of generally-contracted shells by looping over
+  /// their contractions
+  __libint2_engine_inline const target_ptr_vec& compute1_general(
+      const libint2::Shell& s1, const libint2::Shell& s2);
+  /// computes 2-body shell sets of generally-contracted shells by looping over
+  /// their contractions; shell pairs and core integrals are reused
+  template <Operator oper, BraKet braket, size_t deriv_order>
+  __libint2_engine_inline const target_ptr_vec& compute2_general(
+      const Shell& bra1, const Shell& bra2, const Shell& ket1,
+      const Shell& ket2, const ShellPair* spbra, const ShellPair* spket);
+  /// splits \c s into one-contraction shells in \c gencon_shells_[i]
+  __libint2_engine_inline void make_segmented_shells(size_t i, const Shell& s);
+  /// accumulates the shell sets currently pointed to by targets_ into
+  /// gencon_results_, as the block with function offsets \c off of the
+  /// shell set with (total) sizes \c n ; \c nseg are the block sizes
+  __libint2_engine_inline void scatter_gencon_block(
+      size_t nshsets, const std::array<size_t, 4>& n,
+      const std::array<size_t, 4>& nseg, const std::array<size_t, 4>& off);
+
+  /// generally-contracted shell views are handled by copying them to Shell
+  static const Shell& as_shell(const Shell& s) { return s; }
+  static Shell as_shell(const ShellView& s) { return s.shell(); }
+
+  /// implements compute() for shells of type \c ShellT
+  template <typename ShellT, size_t nargs>
+  __libint2_engine_inline const target_ptr_vec& compute_shells(
+      const std::array<std::reference_wrapper<const ShellT>, nargs>& shells);
+
+  template <typename ShellT>
   __libint2_engine_inline void compute_primdata(Libint_t& primdata,
-                                                const Shell& s1,
-                                                const Shell& s2, size_t p1,
+                                                const ShellT& s1,
+                                                const ShellT& s2, size_t p1,
                                                 size_t p2, size_t oset);
 
   /// 3-dim array of pointers to help dispatch efficiently based on oper_,
   /// braket_, and deriv_order_
-  __libint2_engine_inline const std::vector<Engine::compute2_ptr_type>&
+  template <typename ShellT = Shell>
+  __libint2_engine_inline const std::vector<Engine::compute2_ptr_t<ShellT>>&
   compute2_ptrs() const;
 
   // max_nprim=0 avoids resizing primdata_
   __libint2_engine_inline void initialize(size_t max_nprim = 0);
   // generic _initializer
   __libint2_engine_inline void _initialize();
+  /// (re)initializes targets_, whose elements are kept in primdata_[0].targets
+  __libint2_engine_inline void init_targets();
+  /// grows primdata_ to hold (at least) \c nprimdata primitive sets
+  __libint2_engine_inline void grow_primdata(size_t nprimdata);
 
   void finalize() {
     if (primdata_.size() != 0) {
@@ -858,12 +1061,25 @@ class Engine {
   /// operator_traits<oper>::core_eval_type
   any make_core_eval_pack(Operator oper) const;
 
+  /// max # of charges whose (non-derivative) nuclear attraction integrals are
+  /// accumulated by a single call to the build function
+  static constexpr size_t max_ncharges_per_batch = 16;
+
   //-------
   // profiling
   //-------
   static const bool skip_core_ints = false;
 };  // struct Engine
 
+/// initializes the library (see initialize() ), and builds the core
+/// evaluators that the engines for operators \c opers with angular momentum
+/// up to \c max_l and derivatives up to \c deriv_order will share; this makes
+/// the subsequent construction of such engines cheap. See Engine::prewarm().
+inline void initialize(std::initializer_list<Operator> opers, int max_l,
+                       int deriv_order = 0) {
+  initialize();
+  for (auto oper : opers) Engine::prewarm(oper, max_l, deriv_order);
+}
 
 }  // namespace libint2
 
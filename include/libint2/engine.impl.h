@@ -58,8 +58,6 @@
 // --enable-profile
 #ifdef LIBINT2_PROFILE
 #define LIBINT2_ENGINE_TIMERS
-// uncomment if want to profile each integral class
-#define LIBINT2_ENGINE_PROFILE_CLASS
 #endif
 // uncomment if want to profile the engine even if library was configured
 // without --enable-profile
@@ -86,7 +84,7 @@ typename std::remove_all_extents<T>::type* to_ptr1(T (&a)[N]) {
         (2emultipole,                \
          (3emultipole,               \
            (sphemultipole,           \
-          (eri, (eri, (eri, (eri, (eri, (eri, (eri, (eri, BOOST_PP_NIL)))))))))))))))))
+          (eri, (eri, (eri, (eri, (eri, (eri, (eri, (eri, (eri, BOOST_PP_NIL))))))))))))))))))
 
 #define BOOST_PP_NBODY_OPERATOR_INDEX_TUPLE \
   BOOST_PP_MAKE_TUPLE(BOOST_PP_LIST_SIZE(BOOST_PP_NBODY_OPERATOR_LIST))
@@ -141,13 +139,27 @@ template <typename... ShellPack>
 __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute(
     const libint2::Shell& first_shell, const ShellPack&... rest_of_shells) {
   constexpr auto nargs = 1 + sizeof...(rest_of_shells);
-  assert(nargs == braket_rank() && "# of arguments to compute() does not match the braket type");
-
   std::array<std::reference_wrapper<const Shell>, nargs> shells{{
       first_shell, rest_of_shells...}};
+  return compute_shells(shells);
+}
+
+template <typename... ShellPack>
+__libint2_engine_inline const Engine::target_ptr_vec& Engine::compute(
+    const libint2::ShellView& first_shell, const ShellPack&... rest_of_shells) {
+  constexpr auto nargs = 1 + sizeof...(rest_of_shells);
+  std::array<std::reference_wrapper<const ShellView>, nargs> shells{{
+      first_shell, rest_of_shells...}};
+  return compute_shells(shells);
+}
+
+template <typename ShellT, size_t nargs>
+__libint2_engine_inline const Engine::target_ptr_vec& Engine::compute_shells(
+    const std::array<std::reference_wrapper<const ShellT>, nargs>& shells) {
+  assert(nargs == braket_rank() && "# of arguments to compute() does not match the braket type");
 
   if (operator_rank() == 1) {
-    if (nargs == 2) return compute1(shells[0], shells[1]);
+    if (nargs == 2) return compute1(shells[0].get(), shells[1].get());
   } else if (operator_rank() == 2) {
     auto compute_ptr_idx = ((static_cast<int>(oper_) -
                              static_cast<int>(Operator::first_2body_oper)) *
@@ -156,13 +168,13 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute(
                              static_cast<int>(BraKet::first_2body_braket))) *
                                nderivorders_2body +
                            deriv_order_;
-    auto compute_ptr = compute2_ptrs()[compute_ptr_idx];
+    auto compute_ptr = compute2_ptrs<ShellT>()[compute_ptr_idx];
     assert(compute_ptr != nullptr && "2-body compute function not found");
     if (nargs == 2)
-      return (this->*compute_ptr)(shells[0], Shell::unit(), shells[1],
-                                  Shell::unit(), nullptr, nullptr);
+      return (this->*compute_ptr)(shells[0], ShellT::unit(), shells[1],
+                                  ShellT::unit(), nullptr, nullptr);
     if (nargs == 3)
-      return (this->*compute_ptr)(shells[0], Shell::unit(), shells[1],
+      return (this->*compute_ptr)(shells[0], ShellT::unit(), shells[1],
                                   shells[2], nullptr, nullptr);
     if (nargs == 4)
       return (this->*compute_ptr)(shells[0], shells[1], shells[2], shells[3], nullptr, nullptr);
@@ -172,15 +184,64 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute(
   return targets_;
 }
 
+/// copies the target shell sets to caller-provided storage
+/// \sa Engine::compute_and_copy()
+template <typename ShellT, typename... ShellPack>
+__libint2_engine_inline bool Engine::compute_and_copy(
+    value_type* const* dest, const std::array<size_t, 4>& strides,
+    value_type scale, bool accumulate, const ShellT& first_shell,
+    const ShellPack&... rest_of_shells) {
+  constexpr auto nargs = 1 + sizeof...(rest_of_shells);
+  static_assert(nargs <= 4, "compute_and_copy() expects at most 4 shells");
+
+  const auto& results = compute(first_shell, rest_of_shells...);
+  if (results[0] == nullptr) return false;
+
+  // the shells occupy the last nargs of the 4 dimensions, the innermost loop
+  // runs over the functions of the last shell
+  const std::array<size_t, nargs> sizes{{first_shell.size(),
+                                         rest_of_shells.size()...}};
+  std::array<size_t, 4> n{{1, 1, 1, 1}};
+  std::array<size_t, 4> str{{0, 0, 0, 0}};
+  for (auto i = 0; i != nargs; ++i) {
+    n[4 - nargs + i] = sizes[i];
+    str[4 - nargs + i] = strides[i];
+  }
+  const auto plain_copy = !accumulate && scale == value_type(1) && str[3] == 1;
+
+  const auto nsets = nshellsets();
+  for (auto s = 0; s != nsets; ++s) {
+    const value_type* src = results[s];
+    for (size_t f0 = 0; f0 != n[0]; ++f0) {
+      for (size_t f1 = 0; f1 != n[1]; ++f1) {
+        for (size_t f2 = 0; f2 != n[2]; ++f2, src += n[3]) {
+          value_type* tgt = dest[s] + f0 * str[0] + f1 * str[1] + f2 * str[2];
+          if (plain_copy)
+            std::copy(src, src + n[3], tgt);
+          else if (accumulate)
+            for (size_t f3 = 0; f3 != n[3]; ++f3)
+              tgt[f3 * str[3]] += scale * src[f3];
+          else
+            for (size_t f3 = 0; f3 != n[3]; ++f3)
+              tgt[f3 * str[3]] = scale * src[f3];
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
 /// Computes target shell sets of 1-body integrals.
 /// @return vector of pointers to target shell sets, the number of sets =
 /// Engine::nshellsets()
 /// \note resulting shell sets are stored in row-major order
+template <typename ShellT>
 __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute1(
-    const libint2::Shell& s1, const libint2::Shell& s2) {
+    const ShellT& s1, const ShellT& s2) {
   // can only handle 1 contraction at a time
-  assert((s1.ncontr() == 1 && s2.ncontr() == 1) &&
-         "generally-contracted shells not yet supported");
+  if (s1.ncontr() != 1 || s2.ncontr() != 1)
+    return compute1_general(as_shell(s1), as_shell(s2));
 
   const auto oper_is_nuclear =
       (oper_ == Operator::nuclear || oper_ == Operator::erf_nuclear ||
@@ -262,15 +323,29 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute1(
     std::fill(std::begin(scratch_),
               std::begin(scratch_) + num_shellsets_computed * ncart12, 0.0);
 
+  // contributions of charges to non-derivative nuclear attraction ints simply
+  // add up, hence can be accumulated by libint as part of the primitive
+  // contraction: a batch of charges is processed by a single call to the
+  // build function. For derivative ints each charge has its own targets.
+  const auto nparam_sets_per_batch =
+      (oper_is_nuclear && deriv_order_ == 0)
+          ? std::max<size_t>(1, std::min<size_t>(primdata_.size() / nprimpairs,
+                                                 size_t(max_ncharges_per_batch)))
+          : size_t(1);
+
   // loop over accumulation batches
-  for (auto pset = 0u; pset != nparam_sets; ++pset) {
+  for (auto pset = 0u; pset < nparam_sets; pset += nparam_sets_per_batch) {
     if (!oper_is_nuclear)
       assert(nparam_sets == 1 && "unexpected number of operator parameters");
+    const auto pset_fence =
+        std::min<size_t>(pset + nparam_sets_per_batch, nparam_sets);
 
     auto p12 = 0;
-    for (auto p1 = 0; p1 != nprim1; ++p1) {
-      for (auto p2 = 0; p2 != nprim2; ++p2, ++p12) {
-        compute_primdata(primdata_[p12], s1, s2, p1, p2, pset);
+    for (auto ps = pset; ps != pset_fence; ++ps) {
+      for (auto p1 = 0; p1 != nprim1; ++p1) {
+        for (auto p2 = 0; p2 != nprim2; ++p2, ++p12) {
+          compute_primdata(primdata_[p12], s1, s2, p1, p2, ps);
+        }
       }
     }
     primdata_[0].contrdepth = p12;
@@ -545,6 +620,72 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute1(
   return targets_;
 }
 
+__libint2_engine_inline void Engine::make_segmented_shells(size_t i,
+                                                           const Shell& s) {
+  auto& segs = gencon_shells_[i];
+  segs.resize(s.ncontr());
+  for (size_t c = 0; c != s.ncontr(); ++c) {
+    auto& seg = segs[c];
+    seg.alpha = s.alpha;
+    seg.contr.resize(1);
+    seg.contr[0] = s.contr[c];
+    seg.O = s.O;
+    // keep the screening data of the parent shell, so that shell pairs
+    // can be shared by all contractions
+    seg.max_ln_coeff = s.max_ln_coeff;
+  }
+}
+
+__libint2_engine_inline void Engine::scatter_gencon_block(
+    size_t nshsets, const std::array<size_t, 4>& n,
+    const std::array<size_t, 4>& nseg, const std::array<size_t, 4>& off) {
+  const auto shset_size = n[0] * n[1] * n[2] * n[3];
+  for (size_t s = 0; s != nshsets; ++s) {
+    const auto* src = targets_[s];
+    if (src == nullptr) continue;  // screened out, results are zero
+    auto* dst = &gencon_results_[s * shset_size];
+    for (size_t f0 = 0; f0 != nseg[0]; ++f0) {
+      for (size_t f1 = 0; f1 != nseg[1]; ++f1) {
+        for (size_t f2 = 0; f2 != nseg[2]; ++f2) {
+          auto* dst_row =
+              dst + ((((off[0] + f0) * n[1] + off[1] + f1) * n[2] + off[2] +
+                      f2) * n[3] + off[3]);
+          const auto* src_row = src + ((f0 * nseg[1] + f1) * nseg[2] + f2) * nseg[3];
+          std::copy(src_row, src_row + nseg[3], dst_row);
+        }
+      }
+    }
+  }
+}
+
+/// Computes target shell sets of 1-body integrals over generally-contracted
+/// shells, one contraction pair at a time.
+__libint2_engine_inline const Engine::target_ptr_vec& Engine::compute1_general(
+    const libint2::Shell& s1, const libint2::Shell& s2) {
+  make_segmented_shells(0, s1);
+  make_segmented_shells(1, s2);
+  const std::array<size_t, 4> n{{s1.size(), s2.size(), 1, 1}};
+  const auto nshsets = targets_.size();
+  gencon_results_.resize(nshsets * n[0] * n[1]);
+  std::fill(gencon_results_.begin(), gencon_results_.end(), value_type(0));
+
+  std::array<size_t, 4> off{{0, 0, 0, 0}};
+  for (const auto& seg1 : gencon_shells_[0]) {
+    off[1] = 0;
+    for (const auto& seg2 : gencon_shells_[1]) {
+      compute1(seg1, seg2);
+      scatter_gencon_block(nshsets, n, {{seg1.size(), seg2.size(), 1, 1}}, off);
+      off[1] += seg2.size();
+    }
+    off[0] += seg1.size();
+  }
+
+  const auto shset_size = n[0] * n[1];
+  for (size_t s = 0; s != nshsets; ++s)
+    targets_[s] = &gencon_results_[s * shset_size];
+  return targets_;
+}
+
 // generic _initializer
 __libint2_engine_inline void Engine::_initialize() {
 #define BOOST_PP_NBODYENGINE_MCR3_ncenter(product) \
@@ -648,28 +789,23 @@ __libint2_engine_inline void Engine::initialize(size_t max_nprim) {
   // initialize braket, if needed
   if (braket_ == BraKet::invalid) braket_ = default_braket(oper_);
 
-  if (max_nprim != 0) primdata_.resize(std::pow(max_nprim, braket_rank()));
-
-  // initialize targets
-  {
-    decltype(targets_)::allocator_type alloc(primdata_[0].targets);
-    targets_ = decltype(targets_)(alloc);
-    // in some cases extra memory use can be avoided if targets_ manages its own
-    // memory
-    // the only instance is where we permute derivative integrals, this calls
-    // for permuting
-    // target indices.
-    const auto permutable_targets =
-        deriv_order_ > 0 &&
-        (braket_ == BraKet::xx_xx || braket_ == BraKet::xs_xx ||
-         braket_ == BraKet::xx_xs);
-    if (permutable_targets)
-      targets_.reserve(max_ntargets + 1);
-    else
-      targets_.reserve(max_ntargets);
-    // will be resized to appropriate size in reset_scratch via _initialize
+  if (max_nprim != 0) {
+    // for 2-body integrals make room for the primitive pairs of one shell pair
+    // only: most primitive quartets are usually screened out, hence compute2()
+    // grows primdata_ to the number of quartets that survive the shell pair
+    // screening as needed
+    const auto nprimdata_rank =
+        rank(oper_) == 2 ? std::min(2, braket_rank()) : braket_rank();
+    size_t nprimdata = std::pow(max_nprim, nprimdata_rank);
+    // make room for batches of charges, see compute1()
+    if ((oper_ == Operator::nuclear || oper_ == Operator::erf_nuclear ||
+         oper_ == Operator::erfc_nuclear) && deriv_order_ == 0)
+      nprimdata *= max_ncharges_per_batch;
+    primdata_.resize(nprimdata);
   }
 
+  init_targets();
+
 #ifdef LIBINT2_ENGINE_TIMERS
   timers.set_now_overhead(25);
 #endif
@@ -680,11 +816,45 @@ __libint2_engine_inline void Engine::initialize(size_t max_nprim) {
   _initialize();
 }
 
+__libint2_engine_inline void Engine::init_targets() {
+  decltype(targets_)::allocator_type alloc(primdata_[0].targets);
+  targets_ = decltype(targets_)(alloc);
+  // in some cases extra memory use can be avoided if targets_ manages its own
+  // memory
+  // the only instances are where we permute derivative integrals, this calls
+  // for permuting
+  // target indices, and where only the unique derivatives are reported, which
+  // relabels the targets
+  const auto permutable_targets =
+      deriv_order_ > 0 &&
+      (braket_ == BraKet::xx_xx || braket_ == BraKet::xs_xx ||
+       braket_ == BraKet::xx_xs);
+  if (permutable_targets || unique_derivs_)
+    targets_.reserve(max_ntargets + 1);
+  else
+    targets_.reserve(max_ntargets);
+  // will be resized to appropriate size in reset_scratch via _initialize
+}
+
+__libint2_engine_inline void Engine::grow_primdata(size_t nprimdata) {
+  // Libint_t objects are plain data, only primdata_[0] owns resources (the
+  // stack), hence can be relocated; but the storage of targets_ moves with it
+  primdata_.resize(nprimdata);
+  init_targets();
+  reset_scratch();
+#if LIBINT2_FLOP_COUNT
+  LIBINT2_PREFIXED_NAME(libint2_init_flopcounter)(&primdata_[0],
+                                                  primdata_.size());
+#endif
+}
+
 namespace detail {
-__libint2_engine_inline std::vector<Engine::compute2_ptr_type>
+template <typename ShellT>
+__libint2_engine_inline std::vector<Engine::compute2_ptr_t<ShellT>>
 init_compute2_ptrs() {
   auto max_ncompute2_ptrs = nopers_2body * nbrakets_2body * nderivorders_2body;
-  std::vector<Engine::compute2_ptr_type> result(max_ncompute2_ptrs, nullptr);
+  std::vector<Engine::compute2_ptr_t<ShellT>> result(max_ncompute2_ptrs,
+                                                     nullptr);
 
 #define BOOST_PP_NBODYENGINE_MCR7(r, product)                                 \
   if (BOOST_PP_TUPLE_ELEM(3, 0, product) >=                                   \
@@ -705,7 +875,7 @@ init_compute2_ptrs() {
     result.at(compute_ptr_idx) = &Engine::compute2<                           \
         static_cast<Operator>(BOOST_PP_TUPLE_ELEM(3, 0, product)),            \
         static_cast<BraKet>(BOOST_PP_TUPLE_ELEM(3, 1, product)),              \
-        BOOST_PP_TUPLE_ELEM(3, 2, product)>;                                  \
+        BOOST_PP_TUPLE_ELEM(3, 2, product), ShellT>;                          \
   }
 
   BOOST_PP_LIST_FOR_EACH_PRODUCT(
@@ -717,10 +887,11 @@ init_compute2_ptrs() {
 }
 }  // namespace detail
 
-__libint2_engine_inline const std::vector<Engine::compute2_ptr_type>&
+template <typename ShellT>
+__libint2_engine_inline const std::vector<Engine::compute2_ptr_t<ShellT>>&
 Engine::compute2_ptrs() const {
-  static std::vector<compute2_ptr_type> compute2_ptrs_ =
-      detail::init_compute2_ptrs();
+  static std::vector<compute2_ptr_t<ShellT>> compute2_ptrs_ =
+      detail::init_compute2_ptrs<ShellT>();
   return compute2_ptrs_;
 }
 
@@ -802,6 +973,25 @@ __libint2_engine_inline any Engine::enforce_params_type(
   return result;
 }
 
+__libint2_engine_inline void Engine::prewarm(Operator oper, int max_l,
+                                             int deriv_order,
+                                             scalar_type precision) {
+  const auto mmax = rank(default_braket(oper)) * max_l + deriv_order;
+  switch (static_cast<int>(oper)) {
+#define BOOST_PP_NBODYENGINE_MCR7(r, data, i, elem)                        \
+  case i:                                                                  \
+    operator_traits<static_cast<Operator>(i)>::core_eval_type::instance(   \
+        mmax, precision);                                                  \
+    break;
+
+    BOOST_PP_LIST_FOR_EACH_I(BOOST_PP_NBODYENGINE_MCR7, _,
+                             BOOST_PP_NBODY_OPERATOR_LIST)
+
+    default:
+      assert(false && "missing case in switch");  // missed a case?
+  }
+}
+
 __libint2_engine_inline any Engine::make_core_eval_pack(Operator oper) const {
   any result;
   switch (static_cast<int>(oper)) {
@@ -853,8 +1043,9 @@ __libint2_engine_inline void Engine::init_core_ints_params(const any& params) {
   }
 }
 
-__libint2_engine_inline void Engine::compute_primdata(Libint_t& primdata, const Shell& s1,
-                                     const Shell& s2, size_t p1, size_t p2,
+template <typename ShellT>
+__libint2_engine_inline void Engine::compute_primdata(Libint_t& primdata, const ShellT& s1,
+                                     const ShellT& s2, size_t p1, size_t p2,
                                      size_t oset) {
   const auto& A = s1.O;
   const auto& B = s2.O;
@@ -1070,10 +1261,10 @@ __libint2_engine_inline void Engine::compute_primdata(Libint_t& primdata, const
 /// \note result is stored in the "chemists"/Mulliken form, (tbra1 tbra2 |tket1
 /// tket2), i.e. bra and ket are in chemists meaning; result is packed in
 /// row-major order.
-template <Operator oper, BraKet braket, size_t deriv_order>
+template <Operator oper, BraKet braket, size_t deriv_order, typename ShellT>
 __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
-    const libint2::Shell& tbra1, const libint2::Shell& tbra2,
-    const libint2::Shell& tket1, const libint2::Shell& tket2,
+    const ShellT& tbra1, const ShellT& tbra2,
+    const ShellT& tket1, const ShellT& tket2,
     const ShellPair* tspbra, const ShellPair* tspket) {
   assert(oper == oper_ && "Engine::compute2 -- operator mismatch");
   assert(braket == braket_ && "Engine::compute2 -- braket mismatch");
@@ -1087,8 +1278,11 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
   //
 
   // can only handle 1 contraction at a time
-  assert((tbra1.ncontr() == 1 && tbra2.ncontr() == 1 && tket1.ncontr() == 1 &&
-          tket2.ncontr() == 1) && "generally-contracted shells are not yet supported");
+  if (tbra1.ncontr() != 1 || tbra2.ncontr() != 1 || tket1.ncontr() != 1 ||
+      tket2.ncontr() != 1)
+    return compute2_general<oper, braket, deriv_order>(
+        as_shell(tbra1), as_shell(tbra2), as_shell(tket1), as_shell(tket2),
+        tspbra, tspket);
 
   // angular momentum limit obeyed?
   assert(tbra1.contr[0].l <= lmax_ && "the angular momentum limit is exceeded");
@@ -1145,14 +1339,17 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
   const auto lmax_bra = std::max(bra1.contr[0].l, bra2.contr[0].l);
   const auto lmax_ket = std::max(ket1.contr[0].l, ket2.contr[0].l);
 
-#ifdef LIBINT2_ENGINE_PROFILE_CLASS
-  class_id id(bra1.contr[0].l, bra2.contr[0].l, ket1.contr[0].l,
-              ket2.contr[0].l);
-  if (class_profiles.find(id) == class_profiles.end()) {
-    class_profile dummy;
-    class_profiles[id] = dummy;
+  // runtime profiling, see Profiler
+  Profiler::Sample profile;
+  if (profile.active()) {
+    profile.key = ClassKey{static_cast<int>(oper), static_cast<int>(braket),
+                           static_cast<int>(deriv_order),
+                           {{bra1.contr[0].l, bra2.contr[0].l, ket1.contr[0].l,
+                             ket2.contr[0].l}}};
+    profile.stats.nshellsets = 1;
+    profile.stats.nprimsets_total =
+        nprim_bra1 * nprim_bra2 * nprim_ket1 * nprim_ket2;
   }
-#endif
 
 // compute primitive data
 #ifdef LIBINT2_ENGINE_TIMERS
@@ -1195,6 +1392,27 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
     // compute all primitive quartet data
     const auto npbra = spbra.primpairs.size();
     const auto npket = spket.primpairs.size();
+    if (primdata_.size() < npbra * npket) grow_primdata(npbra * npket);
+
+    // geminal core integrals are evaluated for all primitive quartets at once,
+    // after the loop over the quartets (core integrals of generally-contracted
+    // shells are cached per quartet, hence are evaluated one at a time)
+    const auto batch_geminal_core_ints =
+        (oper == Operator::cgtg || oper == Operator::cgtg_x_coulomb ||
+         oper == Operator::delcgtg2) &&
+        !gencon_cache_.active;
+    // core ints of the long-range operator of Operator::rs_coulomb
+    if (oper == Operator::rs_coulomb) {
+      const auto ncore = npbra * npket *
+                         (bra1.contr[0].l + bra2.contr[0].l + ket1.contr[0].l +
+                          ket2.contr[0].l + deriv_order + 1);
+      if (rs_core_ints_.size() < ncore) rs_core_ints_.resize(ncore);
+    }
+    if (batch_geminal_core_ints)
+      geminal_batch_.resize(npbra * npket,
+                            bra1.contr[0].l + bra2.contr[0].l +
+                                ket1.contr[0].l + ket2.contr[0].l +
+                                deriv_order);
     for (auto pb = 0; pb != npbra; ++pb) {
       for (auto pk = 0; pk != npket; ++pk) {
         // primitive quartet screening
@@ -1259,13 +1477,30 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
             auto* gm_ptr = &(primdata.LIBINT_T_SS_EREP_SS(0)[0]);
             const auto mmax = amtot + deriv_order;
 
-            if (!skip_core_ints) {
+            // with generally-contracted shells core ints are shared by all
+            // contractions, hence are computed (once) for the max mmax
+            auto* core_ptr = gm_ptr;
+            auto mmax_core = mmax;
+            auto compute_core_ints = !skip_core_ints && !batch_geminal_core_ints;
+            // N.B. the cache only holds the core ints of the first operator
+            if (gencon_cache_.active && oper != Operator::rs_coulomb) {
+              const auto pp = swap_braket ? pk * gencon_cache_.npket + pb
+                                          : pb * gencon_cache_.npket + pk;
+              mmax_core = gencon_cache_.mmax;
+              core_ptr = &gencon_cache_.values[pp * (mmax_core + 1)];
+              if (gencon_cache_.computed[pp])
+                compute_core_ints = false;
+              else
+                gencon_cache_.computed[pp] = 1;
+            }
+
+            if (compute_core_ints) {
               switch (oper) {
                 case Operator::coulomb: {
                   const auto& core_eval_ptr =
                       any_cast<const detail::core_eval_pack_type<Operator::coulomb>&>(core_eval_pack_)
                           .first();
-                  core_eval_ptr->eval(gm_ptr, T, mmax);
+                  core_eval_ptr->eval(core_ptr, T, mmax_core);
                 } break;
                 case Operator::cgtg_x_coulomb: {
                   const auto& core_eval_ptr =
@@ -1278,7 +1513,7 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                   const auto& core_ints_params =
                       any_cast<const typename operator_traits<
                       Operator::cgtg>::oper_params_type&>(core_ints_params_);
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax, core_ints_params,
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core, core_ints_params,
                                       &core_eval_scratch);
                 } break;
                 case Operator::cgtg: {
@@ -1288,7 +1523,7 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                   const auto& core_ints_params =
                       any_cast<const typename operator_traits<
                           Operator::cgtg>::oper_params_type&>(core_ints_params_);
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax, core_ints_params);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core, core_ints_params);
                 } break;
                 case Operator::delcgtg2: {
                   const auto& core_eval_ptr =
@@ -1297,19 +1532,19 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                   const auto& core_ints_params =
                       any_cast<const typename operator_traits<
                           Operator::cgtg>::oper_params_type&>(core_ints_params_);
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax, core_ints_params);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core, core_ints_params);
                 } break;
                 case Operator::delta: {
                   const auto& core_eval_ptr =
                       any_cast<const detail::core_eval_pack_type<Operator::delta>&>(core_eval_pack_)
                           .first();
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core);
                 } break;
                 case Operator::r12: {
                   const auto& core_eval_ptr =
                       any_cast<const detail::core_eval_pack_type<Operator::r12>&>(core_eval_pack_)
                           .first();
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core);
                 } break;
                 case Operator::erf_coulomb: {
                   const auto& core_eval_ptr =
@@ -1318,7 +1553,7 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                   auto core_ints_params =
                       any_cast<const typename operator_traits<
                           Operator::erf_coulomb>::oper_params_type&>(core_ints_params_);
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax, core_ints_params);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core, core_ints_params);
                 } break;
                 case Operator::erfc_coulomb: {
                   const auto& core_eval_ptr =
@@ -1327,15 +1562,41 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                   auto core_ints_params =
                       any_cast<const typename operator_traits<
                           Operator::erfc_coulomb>::oper_params_type&>(core_ints_params_);
-                  core_eval_ptr->eval(gm_ptr, rho, T, mmax, core_ints_params);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core, core_ints_params);
+                } break;
+                case Operator::rs_coulomb: {
+                  const auto& core_eval_ptr =
+                      any_cast<const detail::core_eval_pack_type<Operator::rs_coulomb>&>(core_eval_pack_)
+                          .first();
+                  auto core_ints_params =
+                      any_cast<const typename operator_traits<
+                          Operator::rs_coulomb>::oper_params_type&>(core_ints_params_);
+                  core_eval_ptr->eval(core_ptr, rho, T, mmax_core, core_ints_params,
+                                      &rs_core_ints_[p * (mmax + 1)]);
                 } break;
                 default:
                   assert(false && "missing case in a switch");  // unreachable
               }
             }
 
-            for (auto m = 0; m != mmax + 1; ++m) {
-              gm_ptr[m] *= pfac;
+            if (batch_geminal_core_ints) {
+              // core ints will be computed and scaled by pfac after the loop
+              geminal_batch_.rho[p] = rho;
+              geminal_batch_.T[p] = T;
+              geminal_batch_.pfac[p] = pfac;
+            } else {
+              if (core_ptr != gm_ptr)
+                std::copy(core_ptr, core_ptr + mmax + 1, gm_ptr);
+
+              for (auto m = 0; m != mmax + 1; ++m) {
+                gm_ptr[m] *= pfac;
+              }
+              if (oper == Operator::rs_coulomb) {
+                auto* gm_lr_ptr = &rs_core_ints_[p * (mmax + 1)];
+                for (auto m = 0; m != mmax + 1; ++m) {
+                  gm_lr_ptr[m] *= pfac;
+                }
+              }
             }
 
             if (mmax != 0) {
@@ -1591,21 +1852,59 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
       }    // ket prim pair
     }      // bra prim pair
     primdata_[0].contrdepth = p;
+
+    if (batch_geminal_core_ints && p != 0) {
+      const auto mmax = bra1.contr[0].l + bra2.contr[0].l + ket1.contr[0].l +
+                        ket2.contr[0].l + deriv_order;
+      auto* core_ptr = &geminal_batch_.values[0];
+      const auto& core_ints_params =
+          any_cast<const typename operator_traits<Operator::cgtg>::oper_params_type&>(
+              core_ints_params_);
+      switch (oper) {
+        case Operator::cgtg: {
+          auto& core_eval_pack =
+              any_cast<detail::core_eval_pack_type<Operator::cgtg>&>(
+                  core_eval_pack_);
+          core_eval_pack.first()->eval(
+              core_ptr, &geminal_batch_.rho[0], &geminal_batch_.T[0], p, mmax,
+              core_ints_params, &core_eval_pack.second());
+        } break;
+        case Operator::cgtg_x_coulomb: {
+          auto& core_eval_pack =
+              any_cast<detail::core_eval_pack_type<Operator::cgtg_x_coulomb>&>(
+                  core_eval_pack_);
+          core_eval_pack.first()->eval(
+              core_ptr, &geminal_batch_.rho[0], &geminal_batch_.T[0], p, mmax,
+              core_ints_params, &core_eval_pack.second());
+        } break;
+        case Operator::delcgtg2: {
+          auto& core_eval_pack =
+              any_cast<detail::core_eval_pack_type<Operator::delcgtg2>&>(
+                  core_eval_pack_);
+          core_eval_pack.first()->eval(
+              core_ptr, &geminal_batch_.rho[0], &geminal_batch_.T[0], p, mmax,
+              core_ints_params, &core_eval_pack.second());
+        } break;
+        default:
+          assert(false && "missing case in a switch");  // unreachable
+      }
+      for (auto q = 0; q != p; ++q, core_ptr += mmax + 1) {
+        auto* gm_ptr = &(primdata_[q].LIBINT_T_SS_EREP_SS(0)[0]);
+        const auto pfac = geminal_batch_.pfac[q];
+        for (auto m = 0; m != mmax + 1; ++m) gm_ptr[m] = core_ptr[m] * pfac;
+      }
+    }
   }
 
 #ifdef LIBINT2_ENGINE_TIMERS
-  const auto t0 = timers.stop(0);
-#ifdef LIBINT2_ENGINE_PROFILE_CLASS
-  class_profiles[id].prereqs += t0.count();
-  if (primdata_[0].contrdepth != 0) {
-    class_profiles[id].nshellset += 1;
-    class_profiles[id].nprimset += primdata_[0].contrdepth;
-  }
-#endif
+  timers.stop(0);
 #endif
+  profile.lap(profile.stats.prereqs);
+  profile.stats.nprimsets = primdata_[0].contrdepth;
 
   // all primitive combinations screened out? set 1st target ptr to nullptr
   if (primdata_[0].contrdepth == 0) {
+    profile.stats.nshellsets_screened = 1;
     targets_[0] = nullptr;
     return targets_;
   }
@@ -1617,26 +1916,36 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
 #ifdef LIBINT2_ENGINE_TIMERS
     timers.start(1);
 #endif
+    profile.start_counters();
     auto& stack = primdata_[0].stack[0];
     stack = 0;
     for (auto p = 0; p != primdata_[0].contrdepth; ++p)
       stack += primdata_[p].LIBINT_T_SS_EREP_SS(0)[0];
     primdata_[0].targets[0] = primdata_[0].stack;
+    // the long-range integral of Operator::rs_coulomb
+    if (oper == Operator::rs_coulomb) {
+      if (rs_stack_.empty()) rs_stack_.resize(1);
+      rs_stack_[0] = 0;
+      for (auto p = 0; p != primdata_[0].contrdepth; ++p)
+        rs_stack_[0] += rs_core_ints_[p];
+      primdata_[0].targets[1] = &rs_stack_[0];
+      if (set_targets_) {
+        targets_[0] = primdata_[0].targets[0];
+        targets_[1] = primdata_[0].targets[1];
+      }
+    }
 #ifdef LIBINT2_ENGINE_TIMERS
-    const auto t1 = timers.stop(1);
-#ifdef LIBINT2_ENGINE_PROFILE_CLASS
-    class_profiles[id].build_vrr += t1.count();
-#endif
+    timers.stop(1);
 #endif
+    profile.stop_counters();
+    profile.lap(profile.stats.build);
+    profile.stats.nbytes = nopers() * sizeof(value_type);
   }       // compute directly
   else {  // call libint
 #ifdef LIBINT2_ENGINE_TIMERS
-#ifdef LIBINT2_PROFILE
-    const auto t1_hrr_start = primdata_[0].timers->read(0);
-    const auto t1_vrr_start = primdata_[0].timers->read(1);
-#endif
     timers.start(1);
 #endif
+    profile.start_counters();
 
     size_t buildfnidx;
     switch (braket) {
@@ -1682,23 +1991,54 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
     assert(buildfnptrs_[buildfnidx] && "null build function ptr");
     buildfnptrs_[buildfnidx](&primdata_[0]);
 
+    // Operator::rs_coulomb: repeat the build with the long-range core ints,
+    // using a separate stack to keep the full-range shell sets; the rest of
+    // primitive data is shared
+    if (oper == Operator::rs_coulomb) {
+      const auto nderivsets =
+          num_geometrical_derivatives(braket_rank(), deriv_order);
+      assert(2 * nderivsets <= sizeof(primdata_[0].targets) /
+                                   sizeof(primdata_[0].targets[0]) &&
+             "Operator::rs_coulomb: derivative order not supported");
+      const auto ncore_quartet = bra1.contr[0].l + bra2.contr[0].l +
+                                 ket1.contr[0].l + ket2.contr[0].l +
+                                 deriv_order + 1;
+      for (auto p = 0; p != primdata_[0].contrdepth; ++p)
+        std::copy(&rs_core_ints_[p * ncore_quartet],
+                  &rs_core_ints_[p * ncore_quartet] + ncore_quartet,
+                  &(primdata_[p].LIBINT_T_SS_EREP_SS(0)[0]));
+      for (auto s = 0; s != nderivsets; ++s)
+        primdata_[0].targets[nderivsets + s] = primdata_[0].targets[s];
+      if (rs_stack_.size() < stack_size_) rs_stack_.resize(stack_size_);
+      auto* stack = primdata_[0].stack;
+      primdata_[0].stack = &rs_stack_[0];
+      buildfnptrs_[buildfnidx](&primdata_[0]);
+      primdata_[0].stack = stack;
+      for (auto s = 0; s != nderivsets; ++s)
+        std::swap(primdata_[0].targets[s], primdata_[0].targets[nderivsets + s]);
+    }
+
 #ifdef LIBINT2_ENGINE_TIMERS
-    const auto t1 = timers.stop(1);
-#ifdef LIBINT2_ENGINE_PROFILE_CLASS
-#ifndef LIBINT2_PROFILE
-    class_profiles[id].build_vrr += t1.count();
-#else
-    class_profiles[id].build_hrr += primdata_[0].timers->read(0) - t1_hrr_start;
-    class_profiles[id].build_vrr += primdata_[0].timers->read(1) - t1_vrr_start;
-#endif
-#endif
+    timers.stop(1);
 #endif
+    profile.stop_counters();
+    profile.lap(profile.stats.build);
 
 #ifdef LIBINT2_ENGINE_TIMERS
     timers.start(2);
 #endif
 
-    const auto ntargets = nshellsets();
+    // Libint always computes the full set of derivatives
+    const auto ntargets =
+        nopers() * num_geometrical_derivatives(braket_rank(), deriv_order);
+    // but may need to report only the translationally-unique subset
+    const auto unique_derivs = unique_derivs_ && deriv_order > 0;
+    // # of (computed and reported) derivative shell sets of each operator
+    const auto nderivsets =
+        num_geometrical_derivatives(braket_rank(), deriv_order);
+    const auto nderivsets_reported =
+        unique_derivs ? num_geometrical_derivatives(braket_rank() - 1, deriv_order)
+                      : nderivsets;
 
     // if needed, permute and transform
     if (use_scratch) {
@@ -1734,46 +2074,60 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
 
       auto hotscr = &scratch_[0];  // points to the hot scratch
 
+      // if permuting, the last solid-harmonic transform writes directly
+      // into the target layout, i.e. is fused with the permutation
+      const int last_pure = ket2.contr[0].pure
+                                ? 3
+                                : (ket1.contr[0].pure
+                                       ? 2
+                                       : (bra2.contr[0].pure
+                                              ? 1
+                                              : (bra1.contr[0].pure ? 0 : -1)));
+      const auto fuse_tform_permute = permute && last_pure >= 0;
+      // # of dimensions transformed separately
+      const auto ntform = fuse_tform_permute ? last_pure : 4;
+      // extents of the source of the fused transform (dimensions preceding
+      // last_pure are already transformed, the rest are cartesian)
+      std::array<size_t, 4> fused_src_extents{{nr1, nr2, nc1, nc2}};
+      // the target strides of each source dimension
+      std::array<size_t, 4> fused_tgt_strides;
+      size_t fused_l = 0;
+      if (fuse_tform_permute) {
+        const auto& cartshell = last_pure == 0
+                                    ? bra1
+                                    : (last_pure == 1
+                                           ? bra2
+                                           : (last_pure == 2 ? ket1 : ket2));
+        fused_l = cartshell.contr[0].l;
+        fused_src_extents[last_pure] = cartshell.cartesian_size();
+        const std::array<size_t, 4> tgt_strides{
+            {nr2_tgt * ncol_tgt, ncol_tgt, nc2_tgt, 1}};
+        fused_tgt_strides[0] =
+            swap_braket ? tgt_strides[swap_tket ? 3 : 2]
+                        : tgt_strides[swap_tbra ? 1 : 0];
+        fused_tgt_strides[1] =
+            swap_braket ? tgt_strides[swap_tket ? 2 : 3]
+                        : tgt_strides[swap_tbra ? 0 : 1];
+        fused_tgt_strides[2] =
+            swap_braket ? tgt_strides[swap_tbra ? 1 : 0]
+                        : tgt_strides[swap_tket ? 3 : 2];
+        fused_tgt_strides[3] =
+            swap_braket ? tgt_strides[swap_tbra ? 0 : 1]
+                        : tgt_strides[swap_tket ? 2 : 3];
+      }
+
       // transform to solid harmonics first, then unpermute, if necessary
       for (auto s = 0; s != ntargets; ++s) {
         // when permuting derivatives may need to permute shellsets also, not
         // just integrals
         // within shellsets; this will poins where source shellset s should end
         // up
-        auto s_target = s;
-
-        auto source =
-            primdata_[0].targets[s];  // points to the most recent result
-        auto target = hotscr;
+        // shell set s is derivative d of operator op
+        const auto op = s / nderivsets;
+        const auto d = s % nderivsets;
+        int s_target = d;
 
-        if (bra1.contr[0].pure) {
-          libint2::solidharmonics::transform_first(
-              bra1.contr[0].l, nr2_cart * ncol_cart, source, target);
-          std::swap(source, target);
-        }
-        if (bra2.contr[0].pure) {
-          libint2::solidharmonics::transform_inner(bra1.size(), bra2.contr[0].l,
-                                                   ncol_cart, source, target);
-          std::swap(source, target);
-        }
-        if (ket1.contr[0].pure) {
-          libint2::solidharmonics::transform_inner(nrow, ket1.contr[0].l,
-                                                   nc2_cart, source, target);
-          std::swap(source, target);
-        }
-        if (ket2.contr[0].pure) {
-          libint2::solidharmonics::transform_last(
-              bra1.size() * bra2.size() * ket1.size(), ket2.contr[0].l, source,
-              target);
-          std::swap(source, target);
-        }
-
-        // need to permute?
         if (permute) {
-          // loop over rows of the source matrix
-          const auto* src_row_ptr = source;
-          auto tgt_ptr = target;
-
           // if permuting derivatives ints must update their derivative index
           switch (deriv_order) {
             case 0:
@@ -1789,7 +2143,7 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                     {9, 10, 11, 6, 7, 8, 0, 1, 2, 3, 4, 5}},
                    {{6, 7, 8, 9, 10, 11, 3, 4, 5, 0, 1, 2},
                     {9, 10, 11, 6, 7, 8, 3, 4, 5, 0, 1, 2}}}};
-              s_target = mapDerivIndex1[swap_braket][swap_tbra][swap_tket][s];
+              s_target = mapDerivIndex1[swap_braket][swap_tbra][swap_tket][d];
             } break;
 
             case 2: {
@@ -1842,13 +2196,57 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
                      6,  17, 27, 63, 64, 37, 45, 52, 7,  18, 28, 68, 38,
                      46, 53, 8,  19, 29, 33, 34, 35, 3,  14, 24, 42, 43,
                      4,  15, 25, 50, 5,  16, 26, 0,  1,  2,  12, 13, 23}}}};
-              s_target = mapDerivIndex2[swap_braket][swap_tbra][swap_tket][s];
+              s_target = mapDerivIndex2[swap_braket][swap_tbra][swap_tket][d];
             } break;
 
             default:
               assert(false &&
                      "3-rd and higher derivatives not yet generalized");
           }
+        }
+        if (unique_derivs) {
+          s_target = unique_geometrical_derivative_index(braket_rank(),
+                                                         deriv_order, s_target);
+          if (s_target < 0) continue;  // no need to transform this one
+        }
+        s_target += op * nderivsets_reported;
+
+        auto source =
+            primdata_[0].targets[s];  // points to the most recent result
+        auto target = hotscr;
+
+        if (bra1.contr[0].pure && ntform > 0) {
+          libint2::solidharmonics::transform_first(
+              bra1.contr[0].l, nr2_cart * ncol_cart, source, target);
+          std::swap(source, target);
+        }
+        if (bra2.contr[0].pure && ntform > 1) {
+          libint2::solidharmonics::transform_inner(bra1.size(), bra2.contr[0].l,
+                                                   ncol_cart, source, target);
+          std::swap(source, target);
+        }
+        if (ket1.contr[0].pure && ntform > 2) {
+          libint2::solidharmonics::transform_inner(nrow, ket1.contr[0].l,
+                                                   nc2_cart, source, target);
+          std::swap(source, target);
+        }
+        if (ket2.contr[0].pure && ntform > 3) {
+          libint2::solidharmonics::transform_last(
+              bra1.size() * bra2.size() * ket1.size(), ket2.contr[0].l, source,
+              target);
+          std::swap(source, target);
+        }
+
+        // need to permute?
+        if (fuse_tform_permute) {
+          libint2::solidharmonics::transform_strided(
+              last_pure, fused_l, fused_src_extents, source, fused_tgt_strides,
+              target);
+          std::swap(source, target);
+        } else if (permute) {
+          // loop over rows of the source matrix
+          const auto* src_row_ptr = source;
+          auto tgt_ptr = target;
 
           for (auto r1 = 0; r1 != nr1; ++r1) {
             for (auto r2 = 0; r2 != nr2; ++r2, src_row_ptr += ncol) {
@@ -1914,23 +2312,117 @@ __libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2(
       }     // loop over shellsets
     }       // if need_scratch => needed to transpose and/or tform
     else {  // did not use scratch? may still need to update targets_
-      if (set_targets_) {
+      if (unique_derivs) {
+        for (auto s = 0; s != ntargets; ++s) {
+          const auto s_target = unique_geometrical_derivative_index(
+              braket_rank(), deriv_order, s % nderivsets);
+          if (s_target >= 0)
+            targets_[s / nderivsets * nderivsets_reported + s_target] =
+                primdata_[0].targets[s];
+        }
+      } else if (set_targets_) {
         for (auto s = 0; s != ntargets; ++s)
           targets_[s] = primdata_[0].targets[s];
       }
     }
 
 #ifdef LIBINT2_ENGINE_TIMERS
-    const auto t2 = timers.stop(2);
-#ifdef LIBINT2_ENGINE_PROFILE_CLASS
-    class_profiles[id].tform += t2.count();
-#endif
+    timers.stop(2);
 #endif
+    profile.lap(profile.stats.tform);
+    profile.stats.nbytes = nopers() * nderivsets_reported * bra1.size() *
+                           bra2.size() * ket1.size() * ket2.size() *
+                           sizeof(value_type);
   }  // not (ss|ss)
 
   return targets_;
 }
 
+/// Computes target shell sets of 2-body integrals over generally-contracted
+/// shells. The shell sets are computed one contraction quartet at a time, but
+/// the primitive pair data and the core integrals (which do not depend on the
+/// contraction coefficients, only on the exponents) are computed once and
+/// shared by all contraction quartets.
+template <Operator oper, BraKet braket, size_t deriv_order>
+__libint2_engine_inline const Engine::target_ptr_vec& Engine::compute2_general(
+    const libint2::Shell& tbra1, const libint2::Shell& tbra2,
+    const libint2::Shell& tket1, const libint2::Shell& tket2,
+    const ShellPair* tspbra, const ShellPair* tspket) {
+  const Shell* shells[4] = {&tbra1, &tbra2, &tket1, &tket2};
+  std::array<size_t, 4> n;
+  // core ints are computed for the highest total angular momentum among all
+  // contraction quartets
+  int mmax = deriv_order;
+  for (auto i = 0; i != 4; ++i) {
+    make_segmented_shells(i, *shells[i]);
+    n[i] = shells[i]->size();
+    int lmax = 0;
+    for (const auto& c : shells[i]->contr) lmax = std::max(lmax, c.l);
+    mmax += lmax;
+  }
+
+  // shell pairs are shared by all contractions
+  const ShellPair* spbra = tspbra;
+  const ShellPair* spket = tspket;
+  if (spbra == nullptr) {
+    gencon_spbra_.init(tbra1, tbra2, ln_precision_);
+    gencon_spket_.init(tket1, tket2, ln_precision_);
+    spbra = &gencon_spbra_;
+    spket = &gencon_spket_;
+  }
+
+  // core ints are computed lazily by compute2(), as needed
+  const auto npbra = spbra->primpairs.size();
+  const auto npket = spket->primpairs.size();
+  gencon_cache_.mmax = mmax;
+  gencon_cache_.npket = npket;
+  gencon_cache_.values.resize(npbra * npket * (mmax + 1));
+  gencon_cache_.computed.assign(npbra * npket, 0);
+  struct cache_guard {
+    gencon_core_ints_cache& cache;
+    ~cache_guard() { cache.active = false; }
+  } guard{gencon_cache_};
+  gencon_cache_.active = true;
+
+  const auto nshsets = targets_.size();
+  const auto shset_size = n[0] * n[1] * n[2] * n[3];
+  gencon_results_.resize(nshsets * shset_size);
+  std::fill(gencon_results_.begin(), gencon_results_.end(), value_type(0));
+
+  bool all_screened = true;
+  std::array<size_t, 4> off{{0, 0, 0, 0}};
+  for (const auto& s0 : gencon_shells_[0]) {
+    off[1] = 0;
+    for (const auto& s1 : gencon_shells_[1]) {
+      off[2] = 0;
+      for (const auto& s2 : gencon_shells_[2]) {
+        off[3] = 0;
+        for (const auto& s3 : gencon_shells_[3]) {
+          compute2<oper, braket, deriv_order>(s0, s1, s2, s3, spbra, spket);
+          if (targets_[0] != nullptr) {
+            all_screened = false;
+            scatter_gencon_block(
+                nshsets, n, {{s0.size(), s1.size(), s2.size(), s3.size()}},
+                off);
+          }
+          off[3] += s3.size();
+        }
+        off[2] += s2.size();
+      }
+      off[1] += s1.size();
+    }
+    off[0] += s0.size();
+  }
+
+  if (all_screened) {
+    targets_[0] = nullptr;
+    return targets_;
+  }
+  for (size_t s = 0; s != nshsets; ++s)
+    targets_[s] = &gencon_results_[s * shset_size];
+  return targets_;
+}
+
 #undef BOOST_PP_NBODY_OPERATOR_LIST
 #undef BOOST_PP_NBODY_OPERATOR_INDEX_TUPLE
 #undef BOOST_PP_NBODY_OPERATOR_INDEX_LIST
@@ -1963,6 +2455,24 @@ template const Engine::target_ptr_vec& Engine::compute<Shell, Shell>(
 
 template const Engine::target_ptr_vec& Engine::compute<Shell, Shell, Shell>(
     const Shell& first_shell, const Shell&, const Shell&, const Shell&);
+
+template const Engine::target_ptr_vec& Engine::compute<ShellView>(
+    const ShellView& first_shell, const ShellView&);
+
+template const Engine::target_ptr_vec& Engine::compute<ShellView, ShellView>(
+    const ShellView& first_shell, const ShellView&, const ShellView&);
+
+template const Engine::target_ptr_vec&
+Engine::compute<ShellView, ShellView, ShellView>(const ShellView& first_shell,
+                                                 const ShellView&,
+                                                 const ShellView&,
+                                                 const ShellView&);
+
+template const Engine::target_ptr_vec& Engine::compute1<Shell>(const Shell&,
+                                                               const Shell&);
+
+template const Engine::target_ptr_vec& Engine::compute1<ShellView>(
+    const ShellView&, const ShellView&);
 #endif
 
 }  // namespace libint2
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_enginepool_h_
+#define _libint2_src_lib_libint_enginepool_h_
+
+#include <libint2/util/cxxstd.h>
+#if LIBINT2_CPLUSPLUS_STD < 2011
+# error "libint2/engine_pool.h requires C++11 support"
+#endif
+
+#include <cassert>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <libint2/engine.h>
+
+namespace libint2 {
+
+  /// EnginePool keeps Engine objects for reuse by repeated computations, e.g.
+  /// Fock builds in every SCF iteration, so that their (large) internal buffers
+  /// are allocated once rather than by every computation.
+
+  /// The pool holds a separate set of engines for each thread; an engine
+  /// is identified by the operator, the braket, and the derivative order.
+  /// Engines are constructed lazily, by the first get() call from the owning
+  /// thread, hence on a first-touch system their buffers are allocated on that
+  /// thread's memory node. An engine is reconstructed only if a request
+  /// exceeds the maximum number of primitives or the angular momentum it was
+  /// constructed for.
+  /// \note Each thread must only use its own \c thread_id ; under this
+  ///       condition no locking is needed.
+  class EnginePool {
+    public:
+      /// @param nthreads the number of threads that will use this pool
+      explicit EnginePool(size_t nthreads = 1) : engines_(nthreads) {}
+
+      /// @return the number of threads this pool serves
+      size_t nthreads() const { return engines_.size(); }
+
+      /// returns the engine of thread \c thread_id that can compute integrals
+      /// of operator \c oper over shells with up to \c max_nprim primitives
+      /// and angular momentum up to \c max_l .
+      /// The parameters have the same meaning as in Engine's constructor; the
+      /// engine's precision is reset to \c precision and the unique
+      /// derivatives are turned off, but the operator parameters are as left
+      /// by the previous user, hence must be (re)set with
+      /// Engine::set_params() for operators that have parameters.
+      /// \throw Engine::lmax_exceeded if \c max_l exceeds the angular momentum
+      ///        limit of the library; if get() is called by a worker thread,
+      ///        the exception must be caught there and passed on to the caller
+      ///        (see std::exception_ptr), lest it terminate the program
+      Engine& get(size_t thread_id, Operator oper, size_t max_nprim, int max_l,
+                  int deriv_order = 0,
+                  scalar_type precision = std::numeric_limits<scalar_type>::epsilon(),
+                  BraKet braket = BraKet::invalid) {
+        assert(thread_id < engines_.size() && "EnginePool::get -- invalid thread_id");
+        if (braket == BraKet::invalid) braket = default_braket(oper);
+        auto& entry = engines_[thread_id][std::make_tuple(oper, braket, deriv_order)];
+        if (entry.engine == nullptr || entry.max_nprim < max_nprim ||
+            entry.max_l < max_l) {
+          entry.max_nprim = std::max(entry.max_nprim, max_nprim);
+          entry.max_l = std::max(entry.max_l, max_l);
+          entry.engine.reset(new Engine(oper, entry.max_nprim, entry.max_l,
+                                        deriv_order, precision));
+          if (braket != default_braket(oper)) entry.engine->set_braket(braket);
+        } else {
+          entry.engine->set_precision(precision);
+          entry.engine->set_unique_derivatives(false);
+        }
+        return *entry.engine;
+      }
+
+      /// releases the engines of thread \c thread_id
+      void clear(size_t thread_id) { engines_.at(thread_id).clear(); }
+
+      /// releases all engines; must not be called concurrently with get()
+      void clear() {
+        for (auto& e : engines_) e.clear();
+      }
+
+    private:
+      typedef std::tuple<Operator, BraKet, int> key_type;
+      struct entry_type {
+        size_t max_nprim = 0;
+        int max_l = -1;
+        std::unique_ptr<Engine> engine;
+      };
+      std::vector<std::map<key_type, entry_type>> engines_;
+  };
+
+} // namespace libint2
+
+#endif /* header guard */
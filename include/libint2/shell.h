@@ -316,6 +316,94 @@ namespace libint2 {
     return os;
   }
 
+  /// ShellView is a non-owning, Shell-like view of a shell whose exponents and
+  /// (normalized) contraction coefficients live in externally-owned storage,
+  /// e.g. in the arena of a FlatBasisSet.
+
+  /// ShellView mirrors the data members of Shell (with spans in place of
+  /// std::vector) so that the code templated on the shell type, such as
+  /// ShellPair::init() and Engine::compute1()/Engine::compute2(), accepts it
+  /// in place of Shell. Views are cheap to copy; they are valid as long as
+  /// the storage they refer to.
+  struct ShellView {
+      typedef Shell::real_t real_t;
+
+      /// read-only span of contiguous elements
+      template <typename T>
+      struct span {
+          const T* ptr;
+          size_t n;
+          span() : ptr(nullptr), n(0) {}
+          span(const T* p, size_t sz) : ptr(p), n(sz) {}
+          const T& operator[](size_t i) const { return ptr[i]; }
+          const T* data() const { return ptr; }
+          size_t size() const { return n; }
+          bool empty() const { return n == 0; }
+          const T* begin() const { return ptr; }
+          const T* end() const { return ptr + n; }
+      };
+
+      /// contracted Gaussian = angular momentum + sph/cart flag + contraction coefficients
+      struct Contraction {
+          int l;
+          bool pure;
+          span<real_t> coeff;
+          size_t cartesian_size() const {
+            return (l + 1) * (l + 2) / 2;
+          }
+          size_t size() const {
+              return pure ? (2 * l + 1) : cartesian_size();
+          }
+      };
+
+      span<real_t> alpha; //!< exponents
+      span<Contraction> contr;      //!< contractions
+      std::array<real_t, 3> O;   //!< origin
+      span<real_t> max_ln_coeff; //!< maximum ln of (absolute) contraction coefficient for each primitive
+
+      size_t cartesian_size() const {
+        size_t s = 0;
+        for(const auto& c: contr) { s += c.cartesian_size(); }
+        return s;
+      }
+      size_t size() const {
+        size_t s = 0;
+        for(const auto& c: contr) { s += c.size(); }
+        return s;
+      }
+
+      size_t ncontr() const { return contr.size(); }
+      size_t nprim() const { return alpha.size(); }
+
+      /// @return a Shell that holds a copy of the data of this view
+      Shell shell() const {
+        Shell result;  // N.B. the coefficients are already normalized, do not use the Shell constructor
+        result.alpha.assign(alpha.begin(), alpha.end());
+        result.contr.resize(ncontr());
+        for(size_t c=0; c!=ncontr(); ++c) {
+          result.contr[c].l = contr[c].l;
+          result.contr[c].pure = contr[c].pure;
+          result.contr[c].coeff.assign(contr[c].coeff.begin(), contr[c].coeff.end());
+        }
+        result.O = O;
+        result.max_ln_coeff.assign(max_ln_coeff.begin(), max_ln_coeff.end());
+        return result;
+      }
+
+      /// @return view of the "unit" Shell, @sa Shell::unit()
+      static ShellView unit() {
+        static const real_t zero{0.0};
+        static const real_t one{1.0};
+        static const Contraction unit_contr{0, false, span<real_t>(&one, 1)};
+        ShellView result;
+        result.alpha = span<real_t>(&zero, 1);
+        result.contr = span<Contraction>(&unit_contr, 1);
+        result.O = {{0.0, 0.0, 0.0}};
+        result.max_ln_coeff = span<real_t>(&zero, 1);
+        return result;
+      }
+  };
+
   /// ShellPair pre-computes shell-pair data, primitive pairs are screened to finite precision
   struct ShellPair {
       typedef Shell::real_t real_t;
@@ -338,7 +426,8 @@ namespace libint2 {
         primpairs.reserve(max_nprim*max_nprim);
         for(int i=0; i!=3; ++i) AB[i] = 0.;
       }
-      ShellPair(const Shell& s1, const Shell& s2, real_t ln_prec) {
+      template <typename Shell1, typename Shell2>
+      ShellPair(const Shell1& s1, const Shell2& s2, real_t ln_prec) {
         init(s1, s2, ln_prec);
       }
 
@@ -346,7 +435,10 @@ namespace libint2 {
       /// located at \f$ \{ \vec{A},\vec{B} \} \f$ whose max coefficients in contractions are \f$ \{ \max{|c_a|} , \max{|c_b|} \} \f$ is screened-out (omitted)
       /// if \f$ \exp(-|\vec{A}-\vec{B}|^2 \alpha_a * \alpha_b / (\alpha_a + \alpha_b)) \max{|c_a|} \max{|c_b|} \leq \epsilon \f$
       /// where \f$ \epsilon \f$ is the desired precision of the integrals.
-      void init(const Shell& s1, const Shell& s2, const real_t& ln_prec) {
+      /// @tparam Shell1 Shell or ShellView
+      /// @tparam Shell2 Shell or ShellView
+      template <typename Shell1, typename Shell2>
+      void init(const Shell1& s1, const Shell2& s2, const real_t& ln_prec) {
 
         primpairs.clear();
 
@@ -27,6 +27,7 @@
 #endif
 
 #include <array>
+#include <cassert>
 #include <vector>
 #include <algorithm>
 
@@ -410,6 +411,55 @@ namespace libint2 {
 
     }
 
+    /// transforms dimension \c d of the row-major 4-index tensor \c src of extents \c n
+    /// (\c n[d] is the number of cartesians of angular momentum \c l ) from cartesian
+    /// to solid harmonic Gaussians; element {i0,i1,i2,i3} of the result is written to
+    /// \c tgt[i0*tgt_strides[0]+i1*tgt_strides[1]+i2*tgt_strides[2]+i3*tgt_strides[3]],
+    /// hence the transform can be fused with any permutation of the result.
+    /// \note unlike the other transforms each element of \c tgt is written once,
+    ///       hence \c tgt need not be zeroed
+    template <typename Real>
+    void transform_strided(size_t d, size_t l, const std::array<size_t,4>& n,
+                           const Real *src,
+                           const std::array<size_t,4>& tgt_strides, Real *tgt)
+    {
+      assert(d < 4);
+      const auto& coefs = SolidHarmonicsCoefficients<Real>::instance(l);
+
+      const std::array<size_t,4> src_strides{{n[1]*n[2]*n[3], n[2]*n[3], n[3], 1}};
+      // the 3 dimensions that are not transformed, in order
+      std::array<size_t,3> o;
+      for(size_t i=0, j=0; i!=4; ++i)
+        if (i != d) o[j++] = i;
+      const auto src_stride_c = src_strides[d];
+
+      const auto npure = 2*l+1;
+      // loop over shg
+      for(size_t s=0; s!=npure; ++s) {
+        const auto nc_s = coefs.nnz(s);      // # of cartesians contributing to shg s
+        const auto* c_idxs = coefs.row_idx(s); // indices of cartesians contributing to shg s
+        const auto* c_vals = coefs.row_values(s); // coefficients of cartesians contributing to shg s
+
+        auto tgt_s = tgt + s * tgt_strides[d];
+
+        // loop over other dims
+        for(size_t i0=0; i0!=n[o[0]]; ++i0) {
+          for(size_t i1=0; i1!=n[o[1]]; ++i1) {
+            const auto* src_i01 = src + i0 * src_strides[o[0]] + i1 * src_strides[o[1]];
+            auto tgt_i01 = tgt_s + i0 * tgt_strides[o[0]] + i1 * tgt_strides[o[1]];
+            for(size_t i2=0; i2!=n[o[2]]; ++i2) {
+              const auto* src_i = src_i01 + i2 * src_strides[o[2]];
+              Real value = 0;
+              for(size_t ic=0; ic!=nc_s; ++ic) // loop over contributing cartesians
+                value += c_vals[ic] * src_i[c_idxs[ic] * src_stride_c];
+              tgt_i01[i2 * tgt_strides[o[2]]] = value;
+            }
+          }
+        }
+      }
+
+    }
+
     /// transforms the last two dimensions of \c src from cartesian to solid harmonic Gaussians, stores result to \c tgt
     template <typename Real>
     void tform_last2(size_t n1, int l_row, int l_col, const Real* source_blk, Real* target_blk) {
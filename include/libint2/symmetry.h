@@ -0,0 +1,322 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_symmetry_h_
+#define _libint2_src_lib_libint_symmetry_h_
+
+#include <libint2/util/cxxstd.h>
+#if LIBINT2_CPLUSPLUS_STD < 2011
+# error "libint2/symmetry.h requires C++11 support"
+#endif
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libint2/atom.h>
+#include <libint2/basis.h>
+#include <libint2/solidharmonics.h>
+
+namespace libint2 {
+
+  namespace symmetry {
+
+    /// Operation is an element of \f$ D_{2h} \f$ whose symmetry elements are aligned
+    /// with the Cartesian axes, i.e. it maps \f$ \{x,y,z\} \f$ to \f$ \{\pm x,\pm y,\pm z\} \f$ .
+    struct Operation {
+        std::array<int, 3> sign;  //!< the factors by which x, y, and z are multiplied
+
+        /// @return the Schoenflies symbol of this operation
+        std::string name() const {
+          const auto nflip = (sign[0] < 0) + (sign[1] < 0) + (sign[2] < 0);
+          switch (nflip) {
+            case 0: return "E";
+            case 3: return "i";
+            case 2: return sign[0] > 0 ? "C2(x)" : (sign[1] > 0 ? "C2(y)" : "C2(z)");
+            default: return sign[2] < 0 ? "sigma(xy)" : (sign[1] < 0 ? "sigma(xz)" : "sigma(yz)");
+          }
+        }
+
+        /// @return the image of \c atom
+        Atom operator()(const Atom& atom) const {
+          return Atom{atom.atomic_number, sign[0] * atom.x, sign[1] * atom.y, sign[2] * atom.z};
+        }
+
+        /// @return the factor by which this operation multiplies \f$ x^{l_x} y^{l_y} z^{l_z} \f$
+        int parity(int lx, int ly, int lz) const {
+          return ((sign[0] < 0 && lx % 2) ? -1 : 1) * ((sign[1] < 0 && ly % 2) ? -1 : 1) *
+                 ((sign[2] < 0 && lz % 2) ? -1 : 1);
+        }
+
+        /// @return all operations of \f$ D_{2h} \f$ , the identity first
+        static const std::vector<Operation>& d2h() {
+          static const std::vector<Operation> ops{{{{1, 1, 1}}},   {{{-1, -1, 1}}}, {{{-1, 1, -1}}},
+                                                  {{{1, -1, -1}}}, {{{-1, -1, -1}}}, {{{1, 1, -1}}},
+                                                  {{{1, -1, 1}}},  {{{-1, 1, 1}}}};
+          return ops;
+        }
+    };
+
+    /// PointGroup is an Abelian point group, i.e. \f$ D_{2h} \f$ or one of its subgroups, of a molecule
+    class PointGroup {
+      public:
+        /// @param atoms the molecule
+        /// @param ops the operations of the group, the identity must be first; must be symmetry operations of \c atoms
+        /// @param tolerance the (absolute, in the units of \c atoms) tolerance for matching the atomic positions
+        /// @throw std::invalid_argument if an operation in \c ops does not map \c atoms onto itself
+        PointGroup(const std::vector<Atom>& atoms, std::vector<Operation> ops, double tolerance = 1e-6) :
+          ops_(std::move(ops)) {
+          for (const auto& op: ops_) {
+            std::vector<size_t> map;
+            if (!map_atoms(atoms, op, tolerance, map))
+              throw std::invalid_argument("PointGroup: " + op.name() + " is not a symmetry operation of the molecule");
+            atom_map_.emplace_back(std::move(map));
+          }
+        }
+
+        /// Finds the largest subgroup of \f$ D_{2h} \f$ whose symmetry elements coincide with the Cartesian axes
+        /// and planes.
+        /// \note the molecule is not reoriented, i.e. its symmetry elements must be aligned with the axes
+        ///       for the symmetry to be detected; otherwise the result is (a subgroup of) the true point group
+        static PointGroup detect(const std::vector<Atom>& atoms, double tolerance = 1e-6) {
+          std::vector<Operation> ops;
+          std::vector<size_t> map;
+          for (const auto& op: Operation::d2h())
+            if (map_atoms(atoms, op, tolerance, map))
+              ops.push_back(op);
+          return PointGroup(atoms, std::move(ops), tolerance);
+        }
+
+        /// @return the Schoenflies symbol of this group, in lower case
+        std::string name() const {
+          switch (order()) {
+            case 1: return "c1";
+            case 2: {
+              const auto n = ops_[1].name();
+              return n == "i" ? "ci" : (n[0] == 'C' ? "c2" : "cs");
+            }
+            case 4: {
+              size_t nrot = 0, ninv = 0;
+              for (const auto& op: ops_) {
+                const auto n = op.name();
+                nrot += (n[0] == 'C') ? 1 : 0;
+                ninv += (n == "i") ? 1 : 0;
+              }
+              return ninv ? "c2h" : (nrot == 3 ? "d2" : "c2v");
+            }
+            case 8: return "d2h";
+            default: assert(false); return "";  // unreachable
+          }
+        }
+
+        /// @return the number of operations
+        size_t order() const { return ops_.size(); }
+        /// @return the operations, the identity first
+        const std::vector<Operation>& operations() const { return ops_; }
+        /// @return atom_map()[g][a] is the index of the atom into which operation \c g maps atom \c a
+        const std::vector<std::vector<size_t>>& atom_map() const { return atom_map_; }
+
+      private:
+        std::vector<Operation> ops_;
+        std::vector<std::vector<size_t>> atom_map_;
+
+        static bool map_atoms(const std::vector<Atom>& atoms, const Operation& op, double tolerance,
+                              std::vector<size_t>& map) {
+          map.resize(atoms.size());
+          for (size_t a = 0; a != atoms.size(); ++a) {
+            const auto image = op(atoms[a]);
+            size_t b = 0;
+            for (; b != atoms.size(); ++b)
+              if (atoms[b].atomic_number == image.atomic_number && std::abs(atoms[b].x - image.x) <= tolerance &&
+                  std::abs(atoms[b].y - image.y) <= tolerance && std::abs(atoms[b].z - image.z) <= tolerance)
+                break;
+            if (b == atoms.size())
+              return false;
+            map[a] = b;
+          }
+          return true;
+        }
+    };
+
+    /// PetiteList determines which shell pairs and shell quartets of a basis are unique
+    /// with respect to the operations of an Abelian point group, and reconstructs the full matrices from
+    /// the contributions of the unique quartets only (Dupuis and King, Int. J. Quantum Chem. 11, 613 (1977)).
+
+    /// The shell quartets are assumed to be in the canonical order used by the Fock builders,
+    /// i.e. \f$ s_1 \geq s_2 \f$, \f$ s_3 \geq s_4 \f$, and \f$ \{s_1,s_2\} \geq \{s_3,s_4\} \f$ .
+    /// A quartet is unique if no operation maps it to a (canonically reordered) quartet that follows it;
+    /// a unique quartet represents all the quartets of its orbit, hence its contribution is to be scaled by
+    /// quartet_weight() . The matrix computed this way ("skeleton") becomes the full matrix after
+    /// symmetrize() .
+    /// \note this is only valid for the totally symmetric densities, e.g. those of the closed-shell ground states
+    class PetiteList {
+      public:
+        /// @param pg the point group
+        /// @param atoms the molecule
+        /// @param shells the basis, on \c atoms ; the atoms related by symmetry must have the same shells
+        /// @throw std::invalid_argument if the basis does not have the symmetry of the molecule
+        PetiteList(const PointGroup& pg, const std::vector<Atom>& atoms, const std::vector<Shell>& shells) :
+          order_(pg.order()), nshells_(shells.size()) {
+          const auto shell2bf = BasisSet::compute_shell2bf(shells);
+          const auto atom2shell = BasisSet::atom2shell(atoms, shells);
+          const auto nbf = shells.empty() ? 0 : shell2bf.back() + shells.back().size();
+
+          shell_map_.resize(order_ * nshells_);
+          bf_map_.resize(order_ * nbf);
+          bf_sign_.resize(order_ * nbf);
+          for (size_t g = 0; g != order_; ++g) {
+            const auto& op = pg.operations()[g];
+            auto* smap = &shell_map_[g * nshells_];
+            std::fill(smap, smap + nshells_, nshells_);
+            for (size_t a = 0; a != atoms.size(); ++a) {
+              const auto& from = atom2shell[a];
+              const auto& to = atom2shell[pg.atom_map()[g][a]];
+              if (from.size() != to.size())
+                throw std::invalid_argument("PetiteList: the basis does not have the symmetry of the molecule");
+              for (size_t k = 0; k != from.size(); ++k) {
+                if (shells[from[k]].contr != shells[to[k]].contr || shells[from[k]].alpha != shells[to[k]].alpha)
+                  throw std::invalid_argument("PetiteList: the basis does not have the symmetry of the molecule");
+                smap[from[k]] = to[k];
+              }
+            }
+            for (size_t s = 0; s != nshells_; ++s) {
+              if (smap[s] == nshells_)
+                throw std::invalid_argument("PetiteList: shell is not centered on an atom");
+              // a function maps onto the same function of the image shell, multiplied by its parity
+              size_t f = 0;
+              for (const auto& c: shells[s].contr) {
+                for (const auto sign: parities(op, c.l, c.pure)) {
+                  bf_map_[g * nbf + shell2bf[s] + f] = shell2bf[smap[s]] + f;
+                  bf_sign_[g * nbf + shell2bf[s] + f] = sign;
+                  ++f;
+                }
+              }
+            }
+          }
+
+          // a pair is unique if no operation maps it to a following pair
+          for (size_t s1 = 0; s1 != nshells_; ++s1)
+            for (size_t s2 = 0; s2 <= s1; ++s2)
+              if (pair_weight(s1, s2) != 0)
+                unique_shell_pairs_.emplace_back(s1, s2);
+        }
+
+        /// @return the order of the point group
+        size_t order() const { return order_; }
+
+        /// @return the index of the shell into which operation \c g maps shell \c s
+        size_t shell_map(size_t g, size_t s) const { return shell_map_[g * nshells_ + s]; }
+
+        /// @return the number of shell pairs in the orbit of shell pair \f$ \{s_1,s_2\}, s_1 \geq s_2 \f$ if it
+        ///         is unique, 0 otherwise
+        size_t pair_weight(size_t s1, size_t s2) const {
+          const auto s12 = pair_index(s1, s2);
+          size_t nstab = 0;  // # of operations that leave the pair unchanged
+          for (size_t g = 0; g != order_; ++g) {
+            const auto gs12 = pair_index(shell_map(g, s1), shell_map(g, s2));
+            if (gs12 > s12) return 0;
+            nstab += (gs12 == s12) ? 1 : 0;
+          }
+          return order_ / nstab;
+        }
+
+        /// @return the unique shell pairs \f$ \{s_1,s_2\}, s_1 \geq s_2 \f$ ; the bra of a unique quartet is
+        ///         always a unique pair
+        const std::vector<std::pair<size_t, size_t>>& unique_shell_pairs() const { return unique_shell_pairs_; }
+
+        /// @return the number of shell quartets in the orbit of the canonically-ordered quartet
+        ///         \f$ \{s_1,s_2,s_3,s_4\} \f$ if it is unique, 0 otherwise
+        size_t quartet_weight(size_t s1, size_t s2, size_t s3, size_t s4) const {
+          const auto s12 = pair_index(s1, s2);
+          const auto s34 = pair_index(s3, s4);
+          size_t nstab = 0;
+          for (size_t g = 0; g != order_; ++g) {
+            auto gs12 = pair_index(shell_map(g, s1), shell_map(g, s2));
+            auto gs34 = pair_index(shell_map(g, s3), shell_map(g, s4));
+            if (gs12 < gs34) std::swap(gs12, gs34);
+            if (gs12 > s12 || (gs12 == s12 && gs34 > s34)) return 0;
+            nstab += (gs12 == s12 && gs34 == s34) ? 1 : 0;
+          }
+          return order_ / nstab;
+        }
+
+        /// Reconstructs the full (symmetric) matrix from its skeleton, i.e. the matrix computed from the unique
+        /// quartets scaled by quartet_weight(), as \f$ F = |G|^{-1} \sum_g R_g F' R_g^\dagger \f$ .
+        /// @tparam Matrix a square matrix type that supports \c rows() and element access via \c operator()
+        template <typename Matrix>
+        Matrix symmetrize(const Matrix& skeleton) const {
+          const auto nbf = static_cast<size_t>(skeleton.rows());
+          assert(nbf * order_ == bf_map_.size());
+          Matrix result(skeleton);
+          if (order_ == 1) return result;
+          for (size_t i = 0; i != nbf; ++i)
+            for (size_t j = 0; j != nbf; ++j)
+              result(i, j) = 0;
+          const auto scale = 1.0 / order_;
+          for (size_t g = 0; g != order_; ++g) {
+            const auto* map = &bf_map_[g * nbf];
+            const auto* sign = &bf_sign_[g * nbf];
+            for (size_t i = 0; i != nbf; ++i)
+              for (size_t j = 0; j != nbf; ++j)
+                result(map[i], map[j]) += (sign[i] * sign[j] * scale) * skeleton(i, j);
+          }
+          return result;
+        }
+
+      private:
+        size_t order_;
+        size_t nshells_;
+        std::vector<size_t> shell_map_;  // [g][s]
+        std::vector<size_t> bf_map_;     // [g][bf]
+        std::vector<signed char> bf_sign_;  // [g][bf]
+        std::vector<std::pair<size_t, size_t>> unique_shell_pairs_;
+
+        static size_t pair_index(size_t s1, size_t s2) {
+          return s1 >= s2 ? s1 * (s1 + 1) / 2 + s2 : s2 * (s2 + 1) / 2 + s1;
+        }
+
+        /// @return the parities of the functions of a shell with angular momentum \c l under \c op
+        static std::vector<signed char> parities(const Operation& op, int l, bool pure) {
+          std::vector<signed char> cart_parity;
+          int lx, ly, lz;
+          FOR_CART(lx, ly, lz, l)
+            cart_parity.push_back(op.parity(lx, ly, lz));
+          END_FOR_CART
+          if (!pure)
+            return cart_parity;
+          // the real solid harmonics are eigenfunctions of the operations of D2h, hence
+          // each has the parity of any of its Cartesian components
+          const auto& coefs = solidharmonics::SolidHarmonicsCoefficients<double>::instance(l);
+          std::vector<signed char> result(2 * l + 1);
+          for (int p = 0; p != 2 * l + 1; ++p)
+            result[p] = cart_parity[coefs.row_idx(p)[0]];
+          return result;
+        }
+    };
+
+  } // namespace symmetry
+
+} // namespace libint2
+
+#endif /* _libint2_src_lib_libint_symmetry_h_ */
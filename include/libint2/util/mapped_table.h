@@ -0,0 +1,182 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_util_mappedtable_h_
+#define _libint2_src_lib_libint_util_mappedtable_h_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+# define LIBINT2_HAVE_MMAP 1
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace libint2 {
+  namespace detail {
+
+    /// MappedTable is a read-only, memory-mapped view of a table of doubles
+    /// (e.g. the interpolation tables of the Boys function evaluators) that was
+    /// prebuilt by write(). Since the mapping is shared, all processes on a
+    /// node that map the same file share a single copy of the table in the
+    /// page cache, and none of them pays the cost of computing it.
+
+    /// A table file consists of a header, zero-padded to #data_offset bytes
+    /// (a multiple of the page size on common platforms, hence the data is
+    /// suitably aligned for SIMD loads), followed by the data.
+    class MappedTable {
+      public:
+        /// the header of a table file
+        struct header_type {
+          char magic[8];       //!< "LIBINT2T"
+          uint32_t version;    //!< the format version, see #format_version
+          uint32_t real_size;  //!< sizeof(double) of the writer
+          uint32_t kind;       //!< identifies the table type, chosen by the user of the table
+          int32_t mmax;        //!< the maximum Boys function index in the table
+          int32_t order;       //!< the interpolation order
+          int32_t reserved;
+          double params[4];    //!< additional parameters (interval size, precision, etc.)
+          uint64_t size;       //!< the number of doubles in the table
+          uint64_t checksum;   //!< checksum of the data, see checksum()
+        };
+        static constexpr uint32_t format_version = 1;
+        static constexpr size_t data_offset = 4096;
+
+        /// the directory where the tables are looked up, specified by
+        /// LIBINT_BOYS_TABLE_PATH environmental variable;
+        /// @return the directory name, or empty string if the variable is not set
+        static std::string path() {
+          const char* path_env = getenv("LIBINT_BOYS_TABLE_PATH");
+          return path_env ? std::string(path_env) : std::string();
+        }
+
+        /// maps file \c filename and validates its header and checksum
+        /// @return the mapped table, or nullptr if the file does not exist,
+        ///         cannot be mapped, is not of kind \c kind , or is corrupt
+        static std::unique_ptr<const MappedTable> open(const std::string& filename,
+                                                       uint32_t kind) {
+          std::unique_ptr<const MappedTable> result;
+#if defined(LIBINT2_HAVE_MMAP)
+          const int fd = ::open(filename.c_str(), O_RDONLY);
+          if (fd == -1) return result;
+          struct stat sb;
+          const bool have_size = (::fstat(fd, &sb) == 0) &&
+                                 (size_t(sb.st_size) > data_offset);
+          void* addr = have_size ? ::mmap(nullptr, sb.st_size, PROT_READ,
+                                          MAP_SHARED, fd, 0)
+                                 : MAP_FAILED;
+          ::close(fd);  // the mapping outlives the descriptor
+          if (addr == MAP_FAILED) return result;
+          result.reset(new MappedTable(addr, sb.st_size));
+          const auto& hdr = result->header();
+          const bool valid =
+              std::memcmp(hdr.magic, magic(), sizeof(hdr.magic)) == 0 &&
+              hdr.version == format_version &&
+              hdr.real_size == sizeof(double) && hdr.kind == kind &&
+              data_offset + hdr.size * sizeof(double) == result->nbytes_ &&
+              hdr.checksum == checksum(result->data(), hdr.size);
+          if (!valid) result.reset();
+#endif
+          return result;
+        }
+
+        /// writes a table file that can be mapped by open(); the file is
+        /// written under a temporary name and then renamed to \c filename ,
+        /// hence processes that concurrently open() it never see a partial file
+        /// @param hdr the header; its \c magic , \c version , \c real_size ,
+        ///        \c size , and \c checksum fields are set by this function
+        /// @return true if the file was written successfully
+        static bool write(const std::string& filename, header_type hdr,
+                          const double* data, size_t size) {
+          std::memcpy(hdr.magic, magic(), sizeof(hdr.magic));
+          hdr.version = format_version;
+          hdr.real_size = sizeof(double);
+          hdr.size = size;
+          hdr.checksum = checksum(data, size);
+          std::vector<char> padded_header(data_offset, 0);
+          std::memcpy(padded_header.data(), &hdr, sizeof(hdr));
+
+#if defined(LIBINT2_HAVE_MMAP)
+          const std::string tmp_filename = filename + ".tmp" + std::to_string(::getpid());
+#else
+          const std::string tmp_filename = filename + ".tmp";
+#endif
+          {
+            std::ofstream os(tmp_filename, std::ios::binary | std::ios::trunc);
+            os.write(padded_header.data(), padded_header.size());
+            os.write(reinterpret_cast<const char*>(data), size * sizeof(double));
+            if (!os) {
+              os.close();
+              std::remove(tmp_filename.c_str());
+              return false;
+            }
+          }
+          return std::rename(tmp_filename.c_str(), filename.c_str()) == 0;
+        }
+
+        /// computes the checksum (64-bit FNV-1a over 8-byte words) of \c size doubles
+        static uint64_t checksum(const double* data, size_t size) {
+          uint64_t result = 0xcbf29ce484222325ULL;
+          for (size_t i = 0; i != size; ++i) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            result = (result ^ word) * 0x100000001b3ULL;
+          }
+          return result;
+        }
+
+        ~MappedTable() {
+#if defined(LIBINT2_HAVE_MMAP)
+          ::munmap(addr_, nbytes_);
+#endif
+        }
+
+        const header_type& header() const {
+          return *static_cast<const header_type*>(addr_);
+        }
+        const double* data() const {
+          return reinterpret_cast<const double*>(static_cast<const char*>(addr_) +
+                                                 data_offset);
+        }
+
+      private:
+        MappedTable(void* addr, size_t nbytes) : addr_(addr), nbytes_(nbytes) {}
+        MappedTable(const MappedTable&) = delete;
+        MappedTable& operator=(const MappedTable&) = delete;
+
+        static const char* magic() { return "LIBINT2T"; }
+
+        void* addr_;
+        size_t nbytes_;
+    };
+
+  }  // namespace detail
+}  // namespace libint2
+
+#endif  // header guard
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_perfcounters_h_
+#define _libint2_src_lib_libint_perfcounters_h_
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+# define LIBINT2_HAVE_PERF_EVENT 1
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+namespace libint2 {
+
+  /// PerfCounters counts hardware events (cycles, instructions, etc.) of the
+  /// calling thread using Linux perf_event interface.
+
+  /// The events are opened as a single group, so that all of them are counted
+  /// over the same intervals and can be read with a single system call.
+  /// The events that cannot be opened (no PMU, e.g. in a virtual machine,
+  /// insufficient permissions, see /proc/sys/kernel/perf_event_paranoid ,
+  /// or a non-Linux system) are not available and always read as zero.
+  /// There is no generic perf event for the floating-point vector operations,
+  /// hence it is specified as a raw (model-specific) event code by
+  /// LIBINT_PERF_FP_EVENT environmental variable, e.g. LIBINT_PERF_FP_EVENT=0x10c7
+  /// counts FP_ARITH_INST_RETIRED.256B_PACKED_DOUBLE on recent Intel CPUs.
+  class PerfCounters {
+    public:
+      enum event { cycles = 0, instructions, cache_misses, fp_ops, nevents };
+      typedef std::array<uint64_t, nevents> values_type;
+      /// (type, config) pair of \c perf_event_attr ; type = -1 means "do not count"
+      typedef std::array<std::pair<int, uint64_t>, nevents> events_type;
+
+      /// opens the default events for the calling thread, see default_events()
+      PerfCounters() : PerfCounters(default_events()) {}
+
+      /// opens \c events for the calling thread
+      explicit PerfCounters(const events_type& events) : leader_(-1) {
+        slot_.fill(-1);
+        fds_.fill(-1);
+#if defined(LIBINT2_HAVE_PERF_EVENT)
+        int nslots = 0;
+        for (int e = 0; e != nevents; ++e) {
+          if (events[e].first < 0) continue;
+          perf_event_attr attr;
+          std::memset(&attr, 0, sizeof(attr));
+          attr.size = sizeof(attr);
+          attr.type = events[e].first;
+          attr.config = events[e].second;
+          attr.disabled = (leader_ == -1);  // the group is enabled at once
+          attr.exclude_kernel = 1;
+          attr.exclude_hv = 1;
+          attr.read_format = PERF_FORMAT_GROUP;
+          const int fd = static_cast<int>(
+              ::syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0));
+          if (fd == -1) continue;
+          if (leader_ == -1) leader_ = fd;
+          fds_[e] = fd;
+          slot_[e] = nslots++;
+        }
+        if (leader_ != -1)
+          ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        (void)events;
+#endif
+      }
+
+      ~PerfCounters() {
+#if defined(LIBINT2_HAVE_PERF_EVENT)
+        for (auto fd : fds_)
+          if (fd != -1) ::close(fd);
+#endif
+      }
+
+      PerfCounters(const PerfCounters&) = delete;
+      PerfCounters& operator=(const PerfCounters&) = delete;
+
+      /// @return true if event \c e is counted
+      bool available(event e) const { return slot_[e] != -1; }
+      /// @return true if any event is counted
+      bool available() const { return leader_ != -1; }
+
+      /// @return the current counts; differences of two reads give the counts
+      ///         over the interval between them
+      values_type read() const {
+        values_type result;
+        result.fill(0);
+#if defined(LIBINT2_HAVE_PERF_EVENT)
+        if (leader_ == -1) return result;
+        uint64_t buf[nevents + 1];  // # of events, followed by the counts
+        if (::read(leader_, buf, sizeof(buf)) < ssize_t(sizeof(uint64_t)))
+          return result;
+        for (int e = 0; e != nevents; ++e)
+          if (slot_[e] != -1 && uint64_t(slot_[e]) < buf[0])
+            result[e] = buf[slot_[e] + 1];
+#endif
+        return result;
+      }
+
+      /// @return the events opened by the default constructor: CPU cycles,
+      ///         instructions, last-level cache misses, and the raw event
+      ///         specified by LIBINT_PERF_FP_EVENT , if any
+      static events_type default_events() {
+        events_type result;
+        result.fill(std::make_pair(-1, uint64_t(0)));
+#if defined(LIBINT2_HAVE_PERF_EVENT)
+        result[cycles] = std::make_pair(int(PERF_TYPE_HARDWARE),
+                                        uint64_t(PERF_COUNT_HW_CPU_CYCLES));
+        result[instructions] = std::make_pair(
+            int(PERF_TYPE_HARDWARE), uint64_t(PERF_COUNT_HW_INSTRUCTIONS));
+        result[cache_misses] = std::make_pair(
+            int(PERF_TYPE_HARDWARE), uint64_t(PERF_COUNT_HW_CACHE_MISSES));
+        const char* fp_event_env = getenv("LIBINT_PERF_FP_EVENT");
+        if (fp_event_env)
+          result[fp_ops] = std::make_pair(
+              int(PERF_TYPE_RAW), uint64_t(std::strtoull(fp_event_env, nullptr, 0)));
+#endif
+        return result;
+      }
+
+      /// @return the counters of the calling thread, opened on first use
+      static const PerfCounters& local() {
+        thread_local PerfCounters counters;
+        return counters;
+      }
+
+    private:
+      int leader_;  //!< file descriptor of the group leader, -1 if none
+      std::array<int, nevents> fds_;
+      std::array<int, nevents> slot_;  //!< position of each event in the group read
+  };
+
+}  // namespace libint2
+
+#endif  // header guard
@@ -0,0 +1,289 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_profile_h_
+#define _libint2_src_lib_libint_profile_h_
+
+#include <libint2/util/cxxstd.h>
+#if LIBINT2_CPLUSPLUS_STD < 2011
+# error "libint2/util/profile.h requires C++11 support"
+#endif
+
+#include <libint2/util/perf_counters.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace libint2 {
+
+  /// identifies a class of shell sets computed by Engine
+  struct ClassKey {
+    int oper;         //!< the operator, as \c static_cast<int>(Operator)
+    int braket;       //!< the braket, as \c static_cast<int>(BraKet)
+    int deriv_order;  //!< the derivative order
+    std::array<int, 4> l;  //!< the angular momenta of the shells, -1 for unused positions
+
+    bool operator<(const ClassKey& other) const {
+      if (oper != other.oper) return oper < other.oper;
+      if (braket != other.braket) return braket < other.braket;
+      if (deriv_order != other.deriv_order) return deriv_order < other.deriv_order;
+      return l < other.l;
+    }
+  };
+
+  /// statistics of the shell sets of one class, accumulated by Profiler
+  struct ClassProfile {
+    size_t nshellsets = 0;           //!< # of shell sets requested
+    size_t nshellsets_screened = 0;  //!< # of shell sets whose primitives were all screened out
+    size_t nprimsets = 0;            //!< # of primitive sets that survived screening
+    size_t nprimsets_total = 0;      //!< # of primitive sets before screening
+    size_t nbytes = 0;               //!< # of bytes of integrals produced
+    double prereqs = 0.0;            //!< time (s) spent computing primitive data
+    double build = 0.0;              //!< time (s) spent in the build functions
+    double tform = 0.0;              //!< time (s) spent transforming and permuting the results
+    /// hardware events counted in the build functions (see PerfCounters),
+    /// if Profiler::enable_counters() is on
+    PerfCounters::values_type counters = PerfCounters::values_type();
+
+    /// @return the fraction of primitive sets screened out
+    double screening_ratio() const {
+      return nprimsets_total == 0 ? 0.0 : 1.0 - double(nprimsets) / nprimsets_total;
+    }
+    /// @return the total time (s)
+    double time() const { return prereqs + build + tform; }
+
+    ClassProfile& operator+=(const ClassProfile& other) {
+      nshellsets += other.nshellsets;
+      nshellsets_screened += other.nshellsets_screened;
+      nprimsets += other.nprimsets;
+      nprimsets_total += other.nprimsets_total;
+      nbytes += other.nbytes;
+      prereqs += other.prereqs;
+      build += other.build;
+      tform += other.tform;
+      for (size_t e = 0; e != counters.size(); ++e)
+        counters[e] += other.counters[e];
+      return *this;
+    }
+  };
+
+  /// Profiler collects ClassProfile statistics of the shell sets computed by
+  /// all Engine objects in the program.
+
+  /// Profiling is off by default, unless LIBINT_PROFILE environmental variable
+  /// is set; it can be turned on and off at any time with enable(). When off,
+  /// the only cost to Engine is a relaxed atomic load per shell set.
+  /// Each thread accumulates into its own statistics (guarded by an uncontended
+  /// lock), which are aggregated on demand by profile(); the statistics of the
+  /// threads that have exited are retained.
+  class Profiler {
+    public:
+      typedef std::map<ClassKey, ClassProfile> profile_type;
+      typedef std::chrono::high_resolution_clock clock_t;
+
+      /// turns profiling on (\c flag = true) or off
+      static void enable(bool flag = true) {
+        enabled_flag().store(flag, std::memory_order_relaxed);
+      }
+      /// @return true if profiling is on
+      static bool enabled() {
+        return enabled_flag().load(std::memory_order_relaxed);
+      }
+
+      /// turns counting of the hardware events in the build functions on
+      /// (\c flag = true) or off; this takes effect only while profiling is on.
+      /// Counting is off by default, unless LIBINT_PROFILE_COUNTERS
+      /// environmental variable is set.
+      /// \note each read of the counters is a system call, hence this is
+      ///       only appropriate for profiling runs
+      static void enable_counters(bool flag = true) {
+        counters_flag().store(flag, std::memory_order_relaxed);
+      }
+      /// @return true if counting of the hardware events is on
+      static bool counters_enabled() {
+        return counters_flag().load(std::memory_order_relaxed);
+      }
+
+      /// adds \c stats to the statistics of class \c key of this thread
+      static void record(const ClassKey& key, const ClassProfile& stats) {
+        auto& data = local();
+        std::lock_guard<std::mutex> lock(data.mutex);
+        data.profile[key] += stats;
+      }
+
+      /// @return the statistics aggregated over all threads
+      static profile_type profile() {
+        profile_type result;
+        std::lock_guard<std::mutex> registry_lock(registry_mutex());
+        for (const auto& data : registry()) {
+          std::lock_guard<std::mutex> lock(data->mutex);
+          for (const auto& p : data->profile) result[p.first] += p.second;
+        }
+        return result;
+      }
+
+      /// clears the statistics of all threads
+      static void reset() {
+        std::lock_guard<std::mutex> registry_lock(registry_mutex());
+        for (const auto& data : registry()) {
+          std::lock_guard<std::mutex> lock(data->mutex);
+          data->profile.clear();
+        }
+      }
+
+      /// writes \c profile to \c os as a JSON object
+      /// \code{.json}
+      /// {"classes": [{"oper": 4, "braket": 7, "deriv_order": 0, "l": [1, 0, 1, 0],
+      ///               "nshellsets": 10, "nshellsets_screened": 0, "nprimsets": 90,
+      ///               "nprimsets_total": 810, "screening_ratio": 0.888889,
+      ///               "nbytes": 720, "prereqs": 1e-05, "build": 2e-05, "tform": 0,
+      ///               "cycles": 0, "instructions": 0, "cache_misses": 0, "fp_ops": 0}]}
+      /// \endcode
+      static void write_json(std::ostream& os, const profile_type& profile = Profiler::profile()) {
+        os << "{\"classes\": [";
+        bool first = true;
+        for (const auto& p : profile) {
+          const auto& k = p.first;
+          const auto& s = p.second;
+          os << (first ? "" : ",") << "\n  {\"oper\": " << k.oper
+             << ", \"braket\": " << k.braket
+             << ", \"deriv_order\": " << k.deriv_order << ", \"l\": [";
+          bool first_l = true;
+          for (auto l : k.l) {
+            if (l < 0) continue;
+            os << (first_l ? "" : ", ") << l;
+            first_l = false;
+          }
+          os << "], \"nshellsets\": " << s.nshellsets
+             << ", \"nshellsets_screened\": " << s.nshellsets_screened
+             << ", \"nprimsets\": " << s.nprimsets
+             << ", \"nprimsets_total\": " << s.nprimsets_total
+             << ", \"screening_ratio\": " << s.screening_ratio()
+             << ", \"nbytes\": " << s.nbytes << ", \"prereqs\": " << s.prereqs
+             << ", \"build\": " << s.build << ", \"tform\": " << s.tform
+             << ", \"cycles\": " << s.counters[PerfCounters::cycles]
+             << ", \"instructions\": " << s.counters[PerfCounters::instructions]
+             << ", \"cache_misses\": " << s.counters[PerfCounters::cache_misses]
+             << ", \"fp_ops\": " << s.counters[PerfCounters::fp_ops] << "}";
+          first = false;
+        }
+        os << "\n]}\n";
+      }
+      /// @return \c profile as a JSON string, see write_json()
+      static std::string json(const profile_type& profile = Profiler::profile()) {
+        std::ostringstream oss;
+        write_json(oss, profile);
+        return oss.str();
+      }
+
+      /// Sample collects the statistics of one shell set, and records them
+      /// when destroyed; does nothing if profiling was off when constructed
+      class Sample {
+        public:
+          Sample()
+              : active_(Profiler::enabled()),
+                count_(active_ && Profiler::counters_enabled()) {
+            if (active_) last_ = clock_t::now();
+          }
+          ~Sample() {
+            if (active_) Profiler::record(key, stats);
+          }
+          Sample(const Sample&) = delete;
+          Sample& operator=(const Sample&) = delete;
+
+          /// @return true if profiling was on when this was constructed
+          bool active() const { return active_; }
+          /// adds the time elapsed since construction or the previous lap to \c t
+          void lap(double& t) {
+            if (active_) {
+              const auto now = clock_t::now();
+              t += std::chrono::duration<double>(now - last_).count();
+              last_ = now;
+            }
+          }
+          /// starts counting the hardware events of this thread
+          void start_counters() {
+            if (count_) counters_start_ = PerfCounters::local().read();
+          }
+          /// adds the hardware events counted since start_counters() to \c stats
+          void stop_counters() {
+            if (count_) {
+              const auto counters_stop = PerfCounters::local().read();
+              for (size_t e = 0; e != counters_stop.size(); ++e)
+                stats.counters[e] += counters_stop[e] - counters_start_[e];
+            }
+          }
+
+          ClassKey key;
+          ClassProfile stats;
+
+        private:
+          bool active_;
+          bool count_;
+          clock_t::time_point last_;
+          PerfCounters::values_type counters_start_;
+      };
+
+    private:
+      struct thread_data {
+        std::mutex mutex;
+        profile_type profile;
+      };
+
+      static std::atomic<bool>& enabled_flag() {
+        static std::atomic<bool> flag(getenv("LIBINT_PROFILE") != nullptr);
+        return flag;
+      }
+      static std::atomic<bool>& counters_flag() {
+        static std::atomic<bool> flag(getenv("LIBINT_PROFILE_COUNTERS") != nullptr);
+        return flag;
+      }
+      static std::vector<std::shared_ptr<thread_data>>& registry() {
+        static std::vector<std::shared_ptr<thread_data>> registry_;
+        return registry_;
+      }
+      static std::mutex& registry_mutex() {
+        static std::mutex mutex;
+        return mutex;
+      }
+      /// @return the statistics of this thread, registered on first use
+      static thread_data& local() {
+        thread_local std::shared_ptr<thread_data> data;
+        if (!data) {
+          data = std::make_shared<thread_data>();
+          std::lock_guard<std::mutex> lock(registry_mutex());
+          registry().push_back(data);
+        }
+        return *data;
+      }
+  };
+
+}  // namespace libint2
+
+#endif  // header guard
@@ -58,6 +58,7 @@
 #include <dims.h>
 #include <purgeable.h>
 #include <buildtest.h>
+#include <costmodel.h>
 #include <libint2/deriv_iter.h>
 
 #include <master_ints_list.h>
@@ -708,6 +709,9 @@ BOOST_PP_LIST_FOR_EACH ( BOOST_PP_ONEBODY_MCR1, _, BOOST_PP_ONEBODY_TASK_LIST)
     cparams->vectorize_by_line(vectorize_by_line);
   }
 #endif
+#if LIBINT_SIMD_CART
+  cparams->simd_cart(true);
+#endif
 #ifdef LIBINT_ALIGN_SIZE
   cparams->align_size(LIBINT_ALIGN_SIZE);
 #endif
@@ -857,6 +861,15 @@ BOOST_PP_LIST_FOR_EACH ( BOOST_PP_ONEBODY_MCR1, _, BOOST_PP_ONEBODY_TASK_LIST)
   // transfer some library configuration to library API
   config_to_api(cparams,iface);
 
+  // write out the generation-time cost estimates for every class
+  {
+    const std::string prefix(cparams->source_directory());
+    std::basic_ofstream<char> csvfile((prefix + "libint2_cost_model.csv").c_str());
+    CostModelReport::Instance().write_csv(csvfile);
+    std::basic_ofstream<char> jsonfile((prefix + "libint2_cost_model.json").c_str());
+    CostModelReport::Instance().write_json(jsonfile);
+  }
+
   os << "Compilation finished. Goodbye." << endl;
 }
 
@@ -1925,12 +1938,28 @@ build_G12DKH_2b_2k(std::ostream& os, const SafePtr<CompilationParameters>& cpara
           std::basic_ofstream<char> declfile(decl_filename.c_str());
           std::basic_ofstream<char> srcfile(src_filename.c_str());
           dg_xxxx->generate_code(context,memman,ImplicitDimensions::default_dims(),SafePtr<CodeSymbols>(new CodeSymbols),label,declfile,srcfile);
+          declfile.flush();
+          srcfile.flush();
 
           // update max stack size
           const SafePtr<TaskParameters>& tparams = taskmgr.current().params();
           tparams->max_stack_size(max_am, memman->max_memory_used());
           tparams->max_ntarget(3);
 
+          // this class is generated without GenerateCode(), hence record its cost model estimates here
+          {
+            CostModelReport& costreport = CostModelReport::Instance();
+            costreport.add(task, label);
+            ClassCost& cost = costreport.current();
+            cost.nflops = dg_xxxx->num_flops();
+            cost.max_stack_size = memman->max_memory_used();
+            cost.nvertices = dg_xxxx->num_vertices();
+            std::ifstream declsize(decl_filename.c_str(), std::ios::binary | std::ios::ate);
+            std::ifstream srcsize(src_filename.c_str(), std::ios::binary | std::ios::ate);
+            cost.code_size = static_cast<unsigned long>(declsize.tellg()) + static_cast<unsigned long>(srcsize.tellg());
+            cost.nfunctions = 1;
+          }
+
           ostringstream oss;
           oss << context->label_to_name(cparams->api_prefix()) << "libint2_build_g12dkh[" << la << "][" << lb << "][" << lc << "]["
               << ld <<"] = " << context->label_to_name(label_to_funcname(label))
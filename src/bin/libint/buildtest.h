@@ -33,6 +33,7 @@
 #include <iface.h>
 #include <dims.h>
 #include <graph_registry.h>
+#include <costmodel.h>
 
 namespace libint2 {
 
@@ -227,6 +228,11 @@ namespace libint2 {
                const std::string& label,
                bool have_parent) {
 
+    // top-level graphs start a new record in the cost model report, prerequisite graphs add to it
+    CostModelReport& costreport = CostModelReport::Instance();
+    if (!have_parent)
+      costreport.add(LibraryTaskManager::Instance().current().label(), label);
+
     dg->apply(strat,tactic);
 #if PRINT_DAG_GRAPHVIZ
     {
@@ -270,6 +276,19 @@ namespace libint2 {
     declfile.close();
     deffile.close();
 
+    // update the cost model estimates for this class
+    {
+      ClassCost& cost = costreport.current();
+      cost.nflops += dg->num_flops();
+      using std::max;
+      cost.max_stack_size = max(cost.max_stack_size, static_cast<unsigned long>(memman->max_memory_used_since_reset()));
+      cost.nvertices += dg->num_vertices();
+      std::ifstream declsize(decl_filename.c_str(), std::ios::binary | std::ios::ate);
+      std::ifstream defsize(def_filename.c_str(), std::ios::binary | std::ios::ate);
+      cost.code_size += static_cast<unsigned long>(declsize.tellg()) + static_cast<unsigned long>(defsize.tellg());
+      ++cost.nfunctions;
+    }
+
     // extract all external symbols
     extract_symbols(dg);
 
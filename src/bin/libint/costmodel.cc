@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <sstream>
+#include <costmodel.h>
+#include <exception.h>
+
+using namespace std;
+using namespace libint2;
+
+namespace {
+  /// @return \c str as a CSV field, quoted if it contains separators, quotes, or line breaks (RFC 4180)
+  std::string csv_escape(const std::string& str) {
+    if (str.find_first_of(",\"\r\n") == std::string::npos)
+      return str;
+    std::string result("\"");
+    for(auto c: str) {
+      if (c == '"')
+        result += '"';
+      result += c;
+    }
+    result += '"';
+    return result;
+  }
+
+  /// @return \c str with the characters that may not appear in a JSON string escaped
+  std::string json_escape(const std::string& str) {
+    std::ostringstream oss;
+    for(auto c: str) {
+      switch (c) {
+        case '"': oss << "\\\""; break;
+        case '\\': oss << "\\\\"; break;
+        case '\n': oss << "\\n"; break;
+        case '\r': oss << "\\r"; break;
+        case '\t': oss << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+            oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<int>(c) << std::dec;
+          else
+            oss << c;
+      }
+    }
+    return oss.str();
+  }
+}
+
+CostModelReport CostModelReport::CMR_obj_;
+
+CostModelReport&
+CostModelReport::Instance()
+{
+  return CMR_obj_;
+}
+
+void
+CostModelReport::add(const std::string& task, const std::string& label)
+{
+  costs_.push_back(ClassCost(task,label));
+}
+
+ClassCost&
+CostModelReport::current()
+{
+  if (costs_.empty())
+    throw ProgrammingError("CostModelReport::current() -- no class has been added");
+  return costs_.back();
+}
+
+void
+CostModelReport::write_csv(std::ostream& os) const
+{
+  os << "task,class,nflops,max_stack_size,nvertices,code_size,nfunctions" << endl;
+  for(Costs::const_iterator c=costs_.begin(); c!=costs_.end(); ++c) {
+    os << csv_escape(c->task) << ","
+       << csv_escape(c->label) << ","
+       << c->nflops << ","
+       << c->max_stack_size << ","
+       << c->nvertices << ","
+       << c->code_size << ","
+       << c->nfunctions << endl;
+  }
+}
+
+void
+CostModelReport::write_json(std::ostream& os) const
+{
+  os << "[" << endl;
+  for(Costs::const_iterator c=costs_.begin(); c!=costs_.end(); ++c) {
+    os << "  {\"task\": \"" << json_escape(c->task) << "\", "
+       << "\"class\": \"" << json_escape(c->label) << "\", "
+       << "\"nflops\": " << c->nflops << ", "
+       << "\"max_stack_size\": " << c->max_stack_size << ", "
+       << "\"nvertices\": " << c->nvertices << ", "
+       << "\"code_size\": " << c->code_size << ", "
+       << "\"nfunctions\": " << c->nfunctions << "}"
+       << (c+1 != costs_.end() ? "," : "") << endl;
+  }
+  os << "]" << endl;
+}
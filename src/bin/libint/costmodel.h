@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_bin_libint_costmodel_h_
+#define _libint2_src_bin_libint_costmodel_h_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace libint2 {
+
+  /**
+     ClassCost is a generation-time estimate of the cost of evaluating one class of integrals
+     (i.e. one top-level function produced by GenerateCode(), together with the functions that
+     compute its prerequisites).
+  */
+  struct ClassCost {
+    ClassCost(const std::string& t, const std::string& l) :
+      task(t), label(l), nflops(0), max_stack_size(0), nvertices(0), code_size(0), nfunctions(0) {}
+
+    /// the task label, e.g. "eri"
+    std::string task;
+    /// the label of the top-level evaluator function
+    std::string label;
+    /// the number of FLOPs (per element of the implicit dimensions, i.e. per primitive combination and vector lane)
+    unsigned long nflops;
+    /// peak stack size (in units of LIBINT2_REALTYPE)
+    unsigned long max_stack_size;
+    /// the number of vertices on the graphs
+    unsigned long nvertices;
+    /// the size of generated source code, in bytes
+    unsigned long code_size;
+    /// the number of generated functions
+    unsigned int nfunctions;
+  };
+
+  /**
+     Collects ClassCost for every class generated by GenerateCode(). This is a Singleton.
+  */
+  class CostModelReport {
+  public:
+    typedef std::vector<ClassCost> Costs;
+
+    /// CostModelReport is a Singleton
+    static CostModelReport& Instance();
+    ~CostModelReport() {}
+
+    /// starts a new record for class \c label of task \c task and makes it current
+    void add(const std::string& task, const std::string& label);
+    /// the current record; throws ProgrammingError if add() has not been called
+    ClassCost& current();
+    /// all records, in the order of generation
+    const Costs& costs() const { return costs_; }
+
+    /// writes the report as comma-separated values, one line per class
+    void write_csv(std::ostream& os) const;
+    /// writes the report as a JSON array, one object per class
+    void write_json(std::ostream& os) const;
+
+  private:
+    CostModelReport() {}
+    Costs costs_;
+
+    static CostModelReport CMR_obj_;
+  };
+
+};
+
+#endif // header guard
@@ -35,6 +35,7 @@ CompilationParameters::CompilationParameters() :
   default_task_name_(Defaults::task_name),
   max_vector_length_(Defaults::max_vector_length),
   vectorize_by_line_(Defaults::vectorize_by_line),
+  simd_cart_(Defaults::simd_cart),
   align_size_(Defaults::align_size), unroll_threshold_(Defaults::unroll_threshold),
   source_directory_(Defaults::source_directory), api_prefix_(Defaults::api_prefix),
   single_evaltype_(Defaults::single_evaltype),
@@ -72,6 +73,8 @@ CompilationParameters::print(std::ostream& os) const
   os << "MAX_VECTOR_LENGTH    = " << max_vector_length() << endl;
   if (max_vector_length() > 1)
     os << "VECTORIZE_BY_LINE    = " << (vectorize_by_line() ? "true" : "false") << endl;
+  else
+    os << "SIMD_CART            = " << (simd_cart() ? "true" : "false") << endl;
   if (align_size() > 0)
     os << "ALIGN_SIZE           = " << align_size() << endl;
   os << "UNROLL_THRESH        = " << unroll_threshold() << endl;
@@ -58,6 +58,10 @@ namespace libint2 {
     bool vectorize_by_line() const {
       return vectorize_by_line_;
     }
+    /// returns whether generic code is vectorized over Cartesian components (only matters if max_vector_length() == 1)
+    bool simd_cart() const {
+      return simd_cart_;
+    }
     /// returns unroll threshold
     unsigned int unroll_threshold() const {
       return unroll_threshold_;
@@ -121,6 +125,10 @@ namespace libint2 {
     void vectorize_by_line(bool flag) {
       vectorize_by_line_ = flag;
     }
+    /// set simd_cart flag
+    void simd_cart(bool flag) {
+      simd_cart_ = flag;
+    }
     /// set alignment size (in units of sizeof(LIBINT_FLOAT))
     void align_size(unsigned int a) {
       align_size_ = a;
@@ -185,6 +193,8 @@ namespace libint2 {
       static const unsigned int max_vector_length = 1;
       /// Vectorize all body by default
       static const bool vectorize_by_line = false;
+      /// Do not vectorize over Cartesian components by default
+      static const bool simd_cart = false;
       /// Use default alignment by default
       static const unsigned int align_size = 0;
       /// Produce quartet-level code by default
@@ -232,6 +242,8 @@ namespace libint2 {
     unsigned int max_vector_length_;
     /// whether to vectorize line-by-line
     bool vectorize_by_line_;
+    /// whether to vectorize generic code over Cartesian components
+    bool simd_cart_;
     /** alignment size in units of sizeof(LIBINT2_REALTYPE).
         UINT_MAX => standard compiler/library default for scalar code, veclen for vectorized code
       */
@@ -57,7 +57,7 @@ namespace {
 
 
 DirectedGraph::DirectedGraph() :
-  stack_(), targets_(), target_accums_(), label_("graph"), func_names_(),
+  stack_(), targets_(), target_accums_(), label_("graph"), nflops_(0), func_names_(),
   registry_(SafePtr<GraphRegistry>(new GraphRegistry)),
   iregistry_(SafePtr<InternalGraphRegistry>(new InternalGraphRegistry)),
   first_to_compute_()
@@ -443,6 +443,7 @@ DirectedGraph::reset()
   targets_.clear();
   first_to_compute_.reset();
   func_names_.clear();
+  nflops_ = 0;
 }
 
 
@@ -2162,6 +2163,7 @@ DirectedGraph::print_def(const SafePtr<CodeContext>& context, std::ostream& os,
   }
 
   // Print out the number of flops
+  nflops_ = nflops_total;
   oss.str(null_str);
   oss << "Number of flops = " << nflops_total;
   os << context->comment(oss.str()) << endl;
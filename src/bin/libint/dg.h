@@ -111,6 +111,10 @@ namespace libint2 {
 
     /// Returns the number of vertices
     unsigned int num_vertices() const { return stack_.size(); }
+    /** Returns the number of FLOPs (per element of the implicit dimensions) in the code generated by
+        the most recent call to generate_code(); 0 if no code has been generated since the last reset()
+     */
+    unsigned int num_flops() const { return nflops_; }
 #if 0
     /// Returns all vertices
     const vertices& all_vertices() const { return stack_; }
@@ -333,6 +337,8 @@ namespace libint2 {
 
     // graph label, used for annotating internal work, e.g. graphviz plots
     std::string label_;
+    // the number of FLOPs in the generated code, see num_flops()
+    unsigned int nflops_;
 
     typedef std::map<std::string,bool> FuncNameContainer;
     /** Maintains the list of names of functions calls to which have been generated so far.
@@ -141,6 +141,17 @@ namespace libint2 {
        */
       bool expl_high_dim() const;
       bool expl_low_dim() const;
+
+#if LIBINT_ENABLE_GENERIC_CODE
+      /// Implementation of RecurrenceRelation::has_generic()
+      bool has_generic(const SafePtr<CompilationParameters>& cparams) const;
+      /// Implementation of RecurrenceRelation::generic_header()
+      std::string generic_header() const { return "GenericHRR.h"; }
+      /// Implementation of RecurrenceRelation::generic_instance()
+      std::string generic_instance(const SafePtr<CodeContext>& context, const SafePtr<CodeSymbols>& args) const;
+      /// Implementation of RecurrenceRelation::generic_symbols()
+      std::list<std::string> generic_symbols() const;
+#endif
     };
 
     template <class IntType, class F, int part,
@@ -676,6 +687,93 @@ namespace libint2 {
         return localdims;
     }
 
+#if LIBINT_ENABLE_GENERIC_CODE
+    template <class IntType, class F, int part,
+    FunctionPosition loc_a, unsigned int pos_a,
+    FunctionPosition loc_b, unsigned int pos_b>
+    bool
+    HRR<IntType,F,part,loc_a,pos_a,loc_b,pos_b>::has_generic(const SafePtr<CompilationParameters>& cparams) const
+    {
+        // generic code is only implemented for simple bra->ket and ket->bra transfers between Cartesian shells
+        if (!boost::is_same<F,CGShell>::value)
+          return false;
+        if (loc_a == loc_b || pos_a != 0 || pos_b != 0)
+          return false;
+
+        F a(loc_a == InBra ? target_->bra(part,pos_a) : target_->ket(part,pos_a));
+        F b(loc_b == InBra ? target_->bra(part,pos_b) : target_->ket(part,pos_b));
+        // derivative HRR has extra terms
+        if (!a.deriv().zero() || !b.deriv().zero())
+          return false;
+
+        // generate generic code if either shell exceeds max_am_opt, else unroll
+        const unsigned int max_opt_am = cparams->max_am_opt();
+        if (a.norm() > max_opt_am || b.norm() > max_opt_am)
+          return true;
+
+        // with SIMD over Cartesian components the generic code vectorizes the
+        // rows of the lower dimension, which the unrolled code does not, hence
+        // use it whenever the lower dimension is not trivial
+        if (cparams->simd_cart() && cparams->max_vector_length() == 1 &&
+            expl_low_dim())
+          return true;
+
+        return false;
+    }
+
+    template <class IntType, class F, int part,
+    FunctionPosition loc_a, unsigned int pos_a,
+    FunctionPosition loc_b, unsigned int pos_b>
+    std::string
+    HRR<IntType,F,part,loc_a,pos_a,loc_b,pos_b>::generic_instance(const SafePtr<CodeContext>& context, const SafePtr<CodeSymbols>& args) const
+    {
+        std::ostringstream oss;
+
+        F a(loc_a == InBra ? target_->bra(part,pos_a) : target_->ket(part,pos_a));
+        F b(loc_b == InBra ? target_->bra(part,pos_b) : target_->ket(part,pos_b));
+        const bool vectorize = (context->cparams()->max_vector_length() == 1) ? false : true;
+
+        oss << "using namespace libint2;" << endl;
+        oss << "libint2::GenericHRR<" << a.norm() << "," << b.norm() << ","
+            << (loc_a == InBra ? "true" : "false") << ","
+            << (vectorize ? "true" : "false")
+            << ">::compute(inteval";
+
+        const unsigned int nargs = args->n();
+        for(unsigned int i=0; i<nargs; i++) {
+          oss << "," << args->symbol(i);
+        }
+
+        // dimensions not shown explicitly are 1
+        oss << "," << (expl_high_dim() ? "highdim" : "1");
+        oss << "," << (expl_low_dim() ? "lowdim" : "1");
+
+        const std::list<std::string> pfacs = generic_symbols();
+        for(std::list<std::string>::const_iterator p=pfacs.begin(); p!=pfacs.end(); ++p)
+          oss << ",inteval->" << *p;
+        oss << ")" << context->end_of_stat() << endl;
+
+        return oss.str();
+    }
+
+    template <class IntType, class F, int part,
+    FunctionPosition loc_a, unsigned int pos_a,
+    FunctionPosition loc_b, unsigned int pos_b>
+    std::list<std::string>
+    HRR<IntType,F,part,loc_a,pos_a,loc_b,pos_b>::generic_symbols() const
+    {
+        using namespace libint2::prefactor;
+        std::list<std::string> result;
+        for(unsigned int xyz=0; xyz<3; ++xyz) {
+          if (loc_a == InBra)
+            result.push_back(prefactors.X_Y[part][xyz]->label());
+          else
+            result.push_back(prefactors.Y_X[part][xyz]->label());
+        }
+        return result;
+    }
+#endif // LIBINT_ENABLE_GENERIC_CODE
+
   };
 
 #endif
@@ -75,6 +75,8 @@ Libint2Iface::Libint2Iface(const SafePtr<CompilationParameters>& cparams,
   ph_ << macro_define("ALIGN_SIZE", cparams_->align_size());
   if (cparams_->count_flops())
     ph_ << macro_define("FLOP_COUNT",1);
+  if (cparams_->simd_cart() && cparams_->max_vector_length() == 1)
+    ph_ << macro_define("SIMD_CART",1);
   if (cparams_->profile())
     ph_ << macro_define("PROFILE",1);
   if (cparams_->accumulate_targets())
@@ -37,7 +37,7 @@ using namespace __gnu_cxx;
 
 MemoryManager::MemoryManager(const Size& maxmem) :
   maxmem_(maxmem), blks_(), superblock_(new MemBlock(Address(0),maxmem,true,SafePtr<MemBlock>(),SafePtr<MemBlock>())),
-  max_memory_used_(0)
+  max_memory_used_(0), max_memory_used_since_reset_(0)
 {
 }
 
@@ -175,6 +175,8 @@ MemoryManager::update_max_memory()
   Address saddr =  superblock()->address();
   if (static_cast<Size>(saddr) > max_memory_used_)
     max_memory_used_  = saddr;
+  if (static_cast<Size>(saddr) > max_memory_used_since_reset_)
+    max_memory_used_since_reset_  = saddr;
 }
 
 void
@@ -190,6 +192,7 @@ MemoryManager::reset()
   memblkset empty_blks;
   swap(blks_,empty_blks);
   superblock_ = SafePtr<MemBlock>(new MemBlock(Address(0),maxmem_,true,SafePtr<MemBlock>(),SafePtr<MemBlock>()));
+  max_memory_used_since_reset_ = 0;
 }
 
 ///////////////
@@ -165,6 +165,8 @@ namespace libint2 {
     SafePtr<MemBlock> superblock_;
     /// Max amount of memory used
     Size max_memory_used_;
+    /// Max amount of memory used since the last reset()
+    Size max_memory_used_since_reset_;
 
     SafePtr<MemBlock> merge_blocks(const SafePtr<MemBlock>& left, const SafePtr<MemBlock>& right);
     SafePtr<MemBlock> merge_to_superblock(const SafePtr<MemBlock>& blk);
@@ -180,6 +182,8 @@ namespace libint2 {
     virtual void free(const Address& address);
     /// Returns the max amount of memory used up to this moment
     Size max_memory_used() const { return max_memory_used_; }
+    /// Returns the max amount of memory used since the last call to reset()
+    Size max_memory_used_since_reset() const { return max_memory_used_since_reset_; }
 
     /// resets the state of MemoryManager; does not invalidate stats, however
     void reset();
@@ -234,6 +234,19 @@ RecurrenceRelation::generate_generic_code(const SafePtr<CodeContext>& context,
   // ... end the body
   def << context->close_block() << endl;
   def << context->code_postfix();
+
+  // add external symbols used by the generic code to each task which requires this RR
+  const std::list<std::string> externsymbols = this->generic_symbols();
+  if (!externsymbols.empty()) {
+    RRStack::InstanceID myid = RRStack::Instance()->find(EnableSafePtrFromThis<this_type>::SafePtr_from_this()).first;
+    typedef LibraryTaskManager::TasksCIter tciter;
+    const tciter tend = taskmgr.plast();
+    for(tciter t=taskmgr.first(); t!=tend; ++t) {
+      const SafePtr<TaskExternSymbols> tsymbols = t->symbols();
+      if (tsymbols->find(myid))
+        tsymbols->add(externsymbols);
+    }
+  }
 }
 
 SafePtr<DirectedGraph>
@@ -370,6 +383,11 @@ RecurrenceRelation::generic_instance(const SafePtr<CodeContext>& context, const
   throw std::logic_error("RecurrenceRelation::generic_instance() -- should not be called! Check if DerivedRecurrenceRelation::generic_instance() is implemented");
 }
 
+std::list<std::string>
+RecurrenceRelation::generic_symbols() const {
+  return std::list<std::string>();
+}
+
 size_t
 RecurrenceRelation::size_of_children() const {
   const auto nchildren = this->num_children();
@@ -25,6 +25,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <list>
 #include <stdexcept>
 #include <exception.h>
 #include <bfset.h>
@@ -226,6 +227,9 @@ namespace libint2 {
     virtual std::string generic_header() const;
     /// return the implementation of this recurrence relation in terms of generic code
     virtual std::string generic_instance(const SafePtr<CodeContext>& context, const SafePtr<CodeSymbols>& args) const;
+    /** return the external symbols (members of the evaluator, e.g. prefactors) referred to by the generic code.
+        Default is none. */
+    virtual std::list<std::string> generic_symbols() const;
 
   };
 
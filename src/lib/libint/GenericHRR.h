@@ -0,0 +1,127 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_generichrr_h_
+#define _libint2_src_lib_libint_generichrr_h_
+
+#include <cstdlib>
+#include <cassert>
+#include <libint2.h>
+#include <util_types.h>
+#include <libint2/cgshell_ordering.h>
+#include <cart_simd.h>
+
+namespace libint2 {
+
+  /** builds ( ... a b ... ) by transferring quanta from b to a:
+      ( ... a b ... ) = ( ... a+1_i b-1_i ... ) + XY_i ( ... a b-1_i ... )
+      src0 = ( ... a+1 b-1 ... )
+      src1 = ( ... a b-1 ... )
+      XY_i is AB_i (CD_i) when a precedes b, BA_i (DC_i) when b precedes a.
+   **/
+  template <int La,       //!< the angular momentum of function a (gains quanta)
+            int Lb,       //!< the angular momentum of function b (loses quanta)
+            bool a_first, //!< true if a is more significant than b (e.g. a in bra, b in ket)
+            bool vectorize> struct GenericHRR {
+
+    static void compute(const Libint_t* inteval,
+                        LIBINT2_REALTYPE* target,
+                        const LIBINT2_REALTYPE* src0,
+                        const LIBINT2_REALTYPE* src1,
+                        unsigned int highdim, //!< number of functions more significant than a and b
+                        unsigned int lowdim, //!<  number of functions less significant than a and b
+                        const LIBINT2_REALTYPE* XY_x,
+                        const LIBINT2_REALTYPE* XY_y,
+                        const LIBINT2_REALTYPE* XY_z) {
+
+      // b-1 must exist
+      assert(Lb > 0);
+
+      const unsigned int veclen = vectorize ? inteval->veclen : 1;
+      const unsigned int lveclen = lowdim * veclen;
+
+      const unsigned int Na = INT_NCART(La);
+      const unsigned int Nap1 = INT_NCART(La+1);
+      const unsigned int Nb = INT_NCART(Lb);
+      const unsigned int Nbm1 = INT_NCART(Lb-1);
+
+      const LIBINT2_REALTYPE* XY[3] = {XY_x, XY_y, XY_z};
+
+      for(unsigned int h=0; h<highdim; ++h) {
+
+        int bx, by, bz;
+        FOR_CART(bx, by, bz, Lb)
+
+          int b[3]; b[0] = bx;  b[1] = by;  b[2] = bz;
+
+          enum XYZ {x=0, y=1, z=2};
+          // Transfer along z, if possible, to match the unrolled HRR code
+          XYZ xyz = x;
+          if (by != 0) xyz = y;
+          if (bz != 0) xyz = z;
+
+          const unsigned int ib = INT_CARTINDEX(Lb,b[0],b[1]);
+          --b[xyz];
+          const unsigned int ibm1 = INT_CARTINDEX(Lb-1,b[0],b[1]);
+          const LIBINT2_REALTYPE* pfac = XY[xyz];
+
+          int ax, ay, az;
+          FOR_CART(ax, ay, az, La)
+
+            int a[3]; a[0] = ax;  a[1] = ay;  a[2] = az;
+
+            const unsigned int ia = INT_CARTINDEX(La,a[0],a[1]);
+            ++a[xyz];
+            const unsigned int iap1 = INT_CARTINDEX(La+1,a[0],a[1]);
+
+            const unsigned int target_offset = (a_first ? (h*Na + ia)*Nb + ib       : (h*Nb + ib)*Na + ia)       * lveclen;
+            const unsigned int src0_offset   = (a_first ? (h*Nap1 + iap1)*Nbm1 + ibm1 : (h*Nbm1 + ibm1)*Nap1 + iap1) * lveclen;
+            const unsigned int src1_offset   = (a_first ? (h*Na + ia)*Nbm1 + ibm1   : (h*Nbm1 + ibm1)*Na + ia)   * lveclen;
+
+            LIBINT2_REALTYPE* target_ptr = target + target_offset;
+            const LIBINT2_REALTYPE* src0_ptr = src0 + src0_offset;
+            const LIBINT2_REALTYPE* src1_ptr = src1 + src1_offset;
+
+            if (cart_simd::enabled<vectorize>::value) {
+              cart_simd::lincomb(lowdim, target_ptr, LIBINT2_REALTYPE(1), src0_ptr, pfac[0], src1_ptr);
+            }
+            else {
+              for(unsigned int l = 0, lv=0; l < lowdim; ++l) {
+                for(unsigned int v=0; v<veclen; ++v, ++lv) {
+                  target_ptr[lv] = src0_ptr[lv] + pfac[v] * src1_ptr[lv];
+                }
+              }
+            }
+#if LIBINT2_FLOP_COUNT
+            inteval->nflops[0] += 2 * lveclen;
+#endif
+
+          END_FOR_CART // end of loop over a
+
+        END_FOR_CART // end of loop over b
+
+      }
+    }
+
+  };
+
+}; // namespace libint2
+
+#endif // header guard
@@ -25,6 +25,7 @@
 #include <libint2.h>
 #include <util_types.h>
 #include <libint2/cgshell_ordering.h>
+#include <cart_simd.h>
 
 namespace libint2 {
 
@@ -136,10 +137,15 @@ namespace libint2 {
           const LIBINT2_REALTYPE* src2_ptr = src2 + am20c0_offset;
           const LIBINT2_REALTYPE axyz = (LIBINT2_REALTYPE)a[xyz];
 
-          unsigned int cv = 0;
-          for(unsigned int c = 0; c < Nc; ++c) {
-            for(unsigned int v=0; v<veclen; ++v, ++cv) {
-              target[cv] = pfac0[v] * src0_ptr[cv] + axyz * inteval->oo2z[v] * src2_ptr[cv];
+          if (cart_simd::enabled<vectorize>::value) {
+            cart_simd::lincomb(Nc, target, pfac0[0], src0_ptr, axyz * inteval->oo2z[0], src2_ptr);
+          }
+          else {
+            unsigned int cv = 0;
+            for(unsigned int c = 0; c < Nc; ++c) {
+              for(unsigned int v=0; v<veclen; ++v, ++cv) {
+                target[cv] = pfac0[v] * src0_ptr[cv] + axyz * inteval->oo2z[v] * src2_ptr[cv];
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
@@ -148,10 +154,15 @@ namespace libint2 {
 
         }
         else {
-          unsigned int cv = 0;
-          for(unsigned int c = 0; c < Nc; ++c) {
-            for(unsigned int v=0; v<veclen; ++v, ++cv) {
-              target[cv] = pfac0[v] * src0_ptr[cv];
+          if (cart_simd::enabled<vectorize>::value) {
+            cart_simd::lincomb(Nc, target, pfac0[0], src0_ptr);
+          }
+          else {
+            unsigned int cv = 0;
+            for(unsigned int c = 0; c < Nc; ++c) {
+              for(unsigned int v=0; v<veclen; ++v, ++cv) {
+                target[cv] = pfac0[v] * src0_ptr[cv];
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
@@ -25,6 +25,7 @@
 #include <libint2.h>
 #include <util_types.h>
 #include <libint2/cgshell_ordering.h>
+#include <cart_simd.h>
 
 #ifdef __GNUC__
 #pragma implementation
@@ -119,12 +120,22 @@ namespace libint2 {
           const LIBINT2_REALTYPE* src3_ptr = src3 + bm20d0_offset;
           const LIBINT2_REALTYPE bxyz = (LIBINT2_REALTYPE)b[xyz];
 
-          unsigned int dv = 0;
-          for(unsigned int d = 0; d < Nd; ++d) {
-            for(unsigned int v=0; v<veclen; ++v, ++dv) {
-              LIBINT2_REALTYPE value = WP[v] * src1_ptr[dv] + bxyz * inteval->oo2z[v] * (src2_ptr[dv] - inteval->roz[v] * src3_ptr[dv]);
-              if (not unit_a) value += PB[v] * src0_ptr[dv];
-              target[dv] = value;
+          if (cart_simd::enabled<vectorize>::value) {
+            const LIBINT2_REALTYPE pfac2 = bxyz * inteval->oo2z[0];
+            const LIBINT2_REALTYPE pfac3 = - pfac2 * inteval->roz[0];
+            if (unit_a)
+              cart_simd::lincomb(Nd, target, WP[0], src1_ptr, pfac2, src2_ptr, pfac3, src3_ptr);
+            else
+              cart_simd::lincomb(Nd, target, WP[0], src1_ptr, pfac2, src2_ptr, pfac3, src3_ptr, PB[0], src0_ptr);
+          }
+          else {
+            unsigned int dv = 0;
+            for(unsigned int d = 0; d < Nd; ++d) {
+              for(unsigned int v=0; v<veclen; ++v, ++dv) {
+                LIBINT2_REALTYPE value = WP[v] * src1_ptr[dv] + bxyz * inteval->oo2z[v] * (src2_ptr[dv] - inteval->roz[v] * src3_ptr[dv]);
+                if (not unit_a) value += PB[v] * src0_ptr[dv];
+                target[dv] = value;
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
@@ -133,12 +144,20 @@ namespace libint2 {
 
         }
         else {
-          unsigned int dv = 0;
-          for(unsigned int d = 0; d < Nd; ++d) {
-            for(unsigned int v=0; v<veclen; ++v, ++dv) {
-              LIBINT2_REALTYPE value = WP[v] * src1_ptr[dv];
-              if (not unit_a) value += PB[v] * src0_ptr[dv];
-              target[dv] = value;
+          if (cart_simd::enabled<vectorize>::value) {
+            if (unit_a)
+              cart_simd::lincomb(Nd, target, WP[0], src1_ptr);
+            else
+              cart_simd::lincomb(Nd, target, WP[0], src1_ptr, PB[0], src0_ptr);
+          }
+          else {
+            unsigned int dv = 0;
+            for(unsigned int d = 0; d < Nd; ++d) {
+              for(unsigned int v=0; v<veclen; ++v, ++dv) {
+                LIBINT2_REALTYPE value = WP[v] * src1_ptr[dv];
+                if (not unit_a) value += PB[v] * src0_ptr[dv];
+                target[dv] = value;
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
@@ -396,10 +415,15 @@ namespace libint2 {
         const LIBINT2_REALTYPE* src1_ptr = src1 + bm10d0_offset;
 
         {
-          unsigned int dv = 0;
-          for(unsigned int d = 0; d < Nd; ++d) {
-            for(unsigned int v=0; v<veclen; ++v, ++dv) {
-              target[dv] = WP[v] * src1_ptr[dv];
+          if (cart_simd::enabled<vectorize>::value) {
+            cart_simd::lincomb(Nd, target, WP[0], src1_ptr);
+          }
+          else {
+            unsigned int dv = 0;
+            for(unsigned int d = 0; d < Nd; ++d) {
+              for(unsigned int v=0; v<veclen; ++v, ++dv) {
+                target[dv] = WP[v] * src1_ptr[dv];
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
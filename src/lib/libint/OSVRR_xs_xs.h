@@ -25,6 +25,7 @@
 #include <libint2.h>
 #include <util_types.h>
 #include <libint2/cgshell_ordering.h>
+#include <cart_simd.h>
 
 namespace libint2 {
 
@@ -115,12 +116,22 @@ namespace libint2 {
           const LIBINT2_REALTYPE* src3_ptr = src3 + am20c0_offset;
           const LIBINT2_REALTYPE axyz = (LIBINT2_REALTYPE)a[xyz];
 
-          unsigned int cv = 0;
-          for(unsigned int c = 0; c < Nc; ++c) {
-            for(unsigned int v=0; v<veclen; ++v, ++cv) {
-              LIBINT2_REALTYPE value = WP[v] * src1_ptr[cv] + axyz * inteval->oo2z[v] * (src2_ptr[cv] - inteval->roz[v] * src3_ptr[cv]);
-              if (not unit_b) value += PA[v] * src0_ptr[cv];
-              target[cv] = value;
+          if (cart_simd::enabled<vectorize>::value) {
+            const LIBINT2_REALTYPE pfac2 = axyz * inteval->oo2z[0];
+            const LIBINT2_REALTYPE pfac3 = - pfac2 * inteval->roz[0];
+            if (unit_b)
+              cart_simd::lincomb(Nc, target, WP[0], src1_ptr, pfac2, src2_ptr, pfac3, src3_ptr);
+            else
+              cart_simd::lincomb(Nc, target, WP[0], src1_ptr, pfac2, src2_ptr, pfac3, src3_ptr, PA[0], src0_ptr);
+          }
+          else {
+            unsigned int cv = 0;
+            for(unsigned int c = 0; c < Nc; ++c) {
+              for(unsigned int v=0; v<veclen; ++v, ++cv) {
+                LIBINT2_REALTYPE value = WP[v] * src1_ptr[cv] + axyz * inteval->oo2z[v] * (src2_ptr[cv] - inteval->roz[v] * src3_ptr[cv]);
+                if (not unit_b) value += PA[v] * src0_ptr[cv];
+                target[cv] = value;
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
@@ -129,12 +140,20 @@ namespace libint2 {
 
         }
         else {
-          unsigned int cv = 0;
-          for(unsigned int c = 0; c < Nc; ++c) {
-            for(unsigned int v=0; v<veclen; ++v, ++cv) {
-              LIBINT2_REALTYPE value = WP[v] * src1_ptr[cv];
-              if (not unit_b) value += PA[v] * src0_ptr[cv];
-              target[cv] = value;
+          if (cart_simd::enabled<vectorize>::value) {
+            if (unit_b)
+              cart_simd::lincomb(Nc, target, WP[0], src1_ptr);
+            else
+              cart_simd::lincomb(Nc, target, WP[0], src1_ptr, PA[0], src0_ptr);
+          }
+          else {
+            unsigned int cv = 0;
+            for(unsigned int c = 0; c < Nc; ++c) {
+              for(unsigned int v=0; v<veclen; ++v, ++cv) {
+                LIBINT2_REALTYPE value = WP[v] * src1_ptr[cv];
+                if (not unit_b) value += PA[v] * src0_ptr[cv];
+                target[cv] = value;
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
@@ -239,10 +258,15 @@ namespace libint2 {
         const LIBINT2_REALTYPE* src1_ptr = src1 + am10c0_offset;
 
         {
-          unsigned int cv = 0;
-          for(unsigned int c = 0; c < Nc; ++c) {
-            for(unsigned int v=0; v<veclen; ++v, ++cv) {
-              target[cv] = WP[v] * src1_ptr[cv];
+          if (cart_simd::enabled<vectorize>::value) {
+            cart_simd::lincomb(Nc, target, WP[0], src1_ptr);
+          }
+          else {
+            unsigned int cv = 0;
+            for(unsigned int c = 0; c < Nc; ++c) {
+              for(unsigned int v=0; v<veclen; ++v, ++cv) {
+                target[cv] = WP[v] * src1_ptr[cv];
+              }
             }
           }
 #if LIBINT2_FLOP_COUNT
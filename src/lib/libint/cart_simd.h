@@ -0,0 +1,177 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _libint2_src_lib_libint_cartsimd_h_
+#define _libint2_src_lib_libint_cartsimd_h_
+
+#include <libint2.h>
+
+/**
+   Linear combinations of contiguous rows of Cartesian components, used by the generic
+   recurrence relation code when the vector length is 1 (i.e. each shell set is computed
+   separately) and the library is configured with --enable-simd-cart (LIBINT2_SIMD_CART).
+   The loops are then explicitly vectorized with the libint2::simd types, so that
+   a single shell set benefits from SIMD instructions; any remainder is handled by scalar code.
+   Non-double types fall back to plain loops.
+ */
+
+#if LIBINT2_SIMD_CART
+# include <libint2/util/vector.h>
+# if defined(__AVX__)
+#  define LIBINT2_CART_SIMD_VECTOR libint2::simd::VectorAVXDouble
+#  define LIBINT2_CART_SIMD_VECLEN 4
+# elif defined(__SSE2__)
+#  define LIBINT2_CART_SIMD_VECTOR libint2::simd::VectorSSEDouble
+#  define LIBINT2_CART_SIMD_VECLEN 2
+# endif
+#endif
+
+namespace libint2 {
+  namespace cart_simd {
+
+    /// enabled<vectorize>::value is true if the generic code instantiated with \c vectorize
+    /// should compute with the kernels below (i.e. if LIBINT2_SIMD_CART is set and the
+    /// code is not vectorized over shell sets), else it uses its own loops
+    template <bool vectorize> struct enabled {
+#if LIBINT2_SIMD_CART
+      static const bool value = !vectorize;
+#else
+      static const bool value = false;
+#endif
+    };
+
+    /// target[i] = a0 * x0[i], i = 0 .. n-1
+    template <typename Real>
+    inline void lincomb(unsigned int n, Real* target,
+                        Real a0, const Real* x0) {
+      for(unsigned int i=0; i<n; ++i)
+        target[i] = a0 * x0[i];
+    }
+
+    /// target[i] = a0 * x0[i] + a1 * x1[i], i = 0 .. n-1
+    template <typename Real>
+    inline void lincomb(unsigned int n, Real* target,
+                        Real a0, const Real* x0,
+                        Real a1, const Real* x1) {
+      for(unsigned int i=0; i<n; ++i)
+        target[i] = a0 * x0[i] + a1 * x1[i];
+    }
+
+    /// target[i] = a0 * x0[i] + a1 * x1[i] + a2 * x2[i], i = 0 .. n-1
+    template <typename Real>
+    inline void lincomb(unsigned int n, Real* target,
+                        Real a0, const Real* x0,
+                        Real a1, const Real* x1,
+                        Real a2, const Real* x2) {
+      for(unsigned int i=0; i<n; ++i)
+        target[i] = a0 * x0[i] + a1 * x1[i] + a2 * x2[i];
+    }
+
+    /// target[i] = a0 * x0[i] + a1 * x1[i] + a2 * x2[i] + a3 * x3[i], i = 0 .. n-1
+    template <typename Real>
+    inline void lincomb(unsigned int n, Real* target,
+                        Real a0, const Real* x0,
+                        Real a1, const Real* x1,
+                        Real a2, const Real* x2,
+                        Real a3, const Real* x3) {
+      for(unsigned int i=0; i<n; ++i)
+        target[i] = a0 * x0[i] + a1 * x1[i] + a2 * x2[i] + a3 * x3[i];
+    }
+
+#if defined(LIBINT2_CART_SIMD_VECTOR)
+    // double-precision overloads, explicitly vectorized
+
+    inline void lincomb(unsigned int n, double* target,
+                        double a0, const double* x0) {
+      typedef LIBINT2_CART_SIMD_VECTOR vector_type;
+      const unsigned int nv = n - n % LIBINT2_CART_SIMD_VECLEN;
+      const vector_type va0(a0);
+      vector_type vx0;
+      unsigned int i = 0;
+      for(; i<nv; i+=LIBINT2_CART_SIMD_VECLEN) {
+        vx0.load(x0 + i);
+        (va0 * vx0).convert(target + i);
+      }
+      for(; i<n; ++i)
+        target[i] = a0 * x0[i];
+    }
+
+    inline void lincomb(unsigned int n, double* target,
+                        double a0, const double* x0,
+                        double a1, const double* x1) {
+      typedef LIBINT2_CART_SIMD_VECTOR vector_type;
+      const unsigned int nv = n - n % LIBINT2_CART_SIMD_VECLEN;
+      const vector_type va0(a0), va1(a1);
+      vector_type vx0, vx1;
+      unsigned int i = 0;
+      for(; i<nv; i+=LIBINT2_CART_SIMD_VECLEN) {
+        vx0.load(x0 + i);
+        vx1.load(x1 + i);
+        (va0 * vx0 + va1 * vx1).convert(target + i);
+      }
+      for(; i<n; ++i)
+        target[i] = a0 * x0[i] + a1 * x1[i];
+    }
+
+    inline void lincomb(unsigned int n, double* target,
+                        double a0, const double* x0,
+                        double a1, const double* x1,
+                        double a2, const double* x2) {
+      typedef LIBINT2_CART_SIMD_VECTOR vector_type;
+      const unsigned int nv = n - n % LIBINT2_CART_SIMD_VECLEN;
+      const vector_type va0(a0), va1(a1), va2(a2);
+      vector_type vx0, vx1, vx2;
+      unsigned int i = 0;
+      for(; i<nv; i+=LIBINT2_CART_SIMD_VECLEN) {
+        vx0.load(x0 + i);
+        vx1.load(x1 + i);
+        vx2.load(x2 + i);
+        (va0 * vx0 + va1 * vx1 + va2 * vx2).convert(target + i);
+      }
+      for(; i<n; ++i)
+        target[i] = a0 * x0[i] + a1 * x1[i] + a2 * x2[i];
+    }
+
+    inline void lincomb(unsigned int n, double* target,
+                        double a0, const double* x0,
+                        double a1, const double* x1,
+                        double a2, const double* x2,
+                        double a3, const double* x3) {
+      typedef LIBINT2_CART_SIMD_VECTOR vector_type;
+      const unsigned int nv = n - n % LIBINT2_CART_SIMD_VECLEN;
+      const vector_type va0(a0), va1(a1), va2(a2), va3(a3);
+      vector_type vx0, vx1, vx2, vx3;
+      unsigned int i = 0;
+      for(; i<nv; i+=LIBINT2_CART_SIMD_VECLEN) {
+        vx0.load(x0 + i);
+        vx1.load(x1 + i);
+        vx2.load(x2 + i);
+        vx3.load(x3 + i);
+        (va0 * vx0 + va1 * vx1 + va2 * vx2 + va3 * vx3).convert(target + i);
+      }
+      for(; i<n; ++i)
+        target[i] = a0 * x0[i] + a1 * x1[i] + a2 * x2[i] + a3 * x3[i];
+    }
+#endif // defined(LIBINT2_CART_SIMD_VECTOR)
+
+  } // namespace cart_simd
+} // namespace libint2
+
+#endif // header guard
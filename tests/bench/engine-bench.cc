@@ -0,0 +1,338 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/// This program measures the throughput of libint2::Engine for every
+/// operator/braket/derivative order combination supported by the library
+/// and every shell set class up to the max angular momentum. Unlike
+/// src/bin/test_eri/time_eri.cc, which times the generated kernels directly, this
+/// includes all Engine overheads (primitive data, prerequisites, cartesian->solid
+/// transformation, permutation, copying). The results are written in JSON format.
+///
+/// usage: engine-bench [max_l] [nprim] [pure] [min_time] [output.json]
+///   max_l    : the max angular momentum of the shells (default = LIBINT2_MAX_AM)
+///   nprim    : the contraction depth of each shell (default = 3)
+///   pure     : 1 to use solid harmonic shells, 0 to use Cartesian shells (default = 1)
+///   min_time : the minimum time, in seconds, spent timing each class (default = 0.1)
+///   output   : the name of the JSON file (default = standard output)
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <libint2.hpp>
+
+using libint2::Shell;
+using libint2::Engine;
+using libint2::Operator;
+using libint2::BraKet;
+
+namespace {
+
+  const char am_letters[] = "spdfghiklmnoqrtuvwxyz";
+
+  const char* to_string(Operator oper) {
+    switch (oper) {
+      case Operator::overlap: return "overlap";
+      case Operator::kinetic: return "kinetic";
+      case Operator::nuclear: return "nuclear";
+      case Operator::erf_nuclear: return "erf_nuclear";
+      case Operator::erfc_nuclear: return "erfc_nuclear";
+      case Operator::emultipole1: return "emultipole1";
+      case Operator::emultipole2: return "emultipole2";
+      case Operator::emultipole3: return "emultipole3";
+      case Operator::sphemultipole: return "sphemultipole";
+      case Operator::delta: return "delta";
+      case Operator::coulomb: return "coulomb";
+      case Operator::cgtg: return "cgtg";
+      case Operator::cgtg_x_coulomb: return "cgtg_x_coulomb";
+      case Operator::delcgtg2: return "delcgtg2";
+      case Operator::r12: return "r12";
+      case Operator::erf_coulomb: return "erf_coulomb";
+      case Operator::erfc_coulomb: return "erfc_coulomb";
+      case Operator::rs_coulomb: return "rs_coulomb";
+      default: return "invalid";
+    }
+  }
+
+  const char* to_string(BraKet braket) {
+    switch (braket) {
+      case BraKet::x_x: return "x_x";
+      case BraKet::xx_xx: return "xx_xx";
+      case BraKet::xs_xx: return "xs_xx";
+      case BraKet::xx_xs: return "xx_xs";
+      case BraKet::xs_xs: return "xs_xs";
+      default: return "invalid";
+    }
+  }
+
+  /// the max derivative order supported by the library for this braket, or -1 if not supported
+  int max_deriv_order(BraKet braket) {
+    switch (braket) {
+#ifdef INCLUDE_ONEBODY
+      case BraKet::x_x: return INCLUDE_ONEBODY;
+#endif
+#ifdef INCLUDE_ERI
+      case BraKet::xx_xx: return INCLUDE_ERI;
+#endif
+#ifdef INCLUDE_ERI3
+      case BraKet::xs_xx:
+      case BraKet::xx_xs: return INCLUDE_ERI3;
+#endif
+#ifdef INCLUDE_ERI2
+      case BraKet::xs_xs: return INCLUDE_ERI2;
+#endif
+      default: return -1;
+    }
+  }
+
+  /// @return reasonable operator parameters; the default parameters of some operators
+  /// (e.g. point charges) would make the integrals vanish trivially
+  libint2::any bench_params(Operator oper) {
+    const std::vector<std::pair<double, std::array<double, 3>>> charges{
+        {8.0, {{0.0, 0.0, 0.0}}},
+        {1.0, {{0.0, 1.4, 1.1}}},
+        {1.0, {{0.0, -1.4, 1.1}}}};
+    const double omega = 1.0;
+    const libint2::ContractedGaussianGeminal cgtg{{0.2, 0.3}, {1.0, 0.4}, {5.0, 0.3}};
+    switch (oper) {
+      case Operator::nuclear:
+        return charges;
+      case Operator::erf_nuclear:
+      case Operator::erfc_nuclear:
+        return std::make_tuple(omega, charges);
+      case Operator::erf_coulomb:
+      case Operator::erfc_coulomb:
+      case Operator::rs_coulomb:
+        return omega;
+      case Operator::cgtg:
+      case Operator::cgtg_x_coulomb:
+      case Operator::delcgtg2:
+        return cgtg;
+      default:
+        return libint2::default_params(oper);
+    }
+  }
+
+  /// makes a shell of angular momentum \c l with \c nprim primitives centered at \c O
+  Shell make_shell(int l, size_t nprim, bool pure, std::array<double, 3> O) {
+    std::vector<double> alpha(nprim);
+    std::vector<double> coeff(nprim, 1.0);
+    // even-tempered exponents
+    for (size_t p = 0; p != nprim; ++p) alpha[p] = 5.0 * std::pow(0.3, p);
+    return Shell{alpha, {{l, pure, coeff}}, O};
+  }
+
+  /// the class label, e.g. "(ps|dd)"
+  std::string class_label(BraKet braket, const std::array<int, 4>& l) {
+    std::string result("(");
+    switch (braket) {
+      case BraKet::x_x:
+        result += am_letters[l[0]]; result += "|"; result += am_letters[l[1]];
+        break;
+      case BraKet::xs_xs:
+        result += am_letters[l[0]]; result += "|"; result += am_letters[l[2]];
+        break;
+      case BraKet::xs_xx:
+        result += am_letters[l[0]]; result += "|";
+        result += am_letters[l[2]]; result += am_letters[l[3]];
+        break;
+      case BraKet::xx_xs:
+        result += am_letters[l[0]]; result += am_letters[l[1]]; result += "|";
+        result += am_letters[l[2]];
+        break;
+      default:
+        result += am_letters[l[0]]; result += am_letters[l[1]]; result += "|";
+        result += am_letters[l[2]]; result += am_letters[l[3]];
+    }
+    result += ")";
+    return result;
+  }
+
+  struct ClassTiming {
+    std::string label;
+    std::array<int, 4> l;
+    size_t nshellsets;  //!< # of shell sets produced by each call to Engine::compute
+    size_t nints;       //!< # of integrals produced by each call to Engine::compute
+    size_t ncalls;
+    double seconds;
+  };
+
+  /// times Engine::compute for shells \c s until at least \c min_time seconds have passed
+  ClassTiming time_class(Engine& engine, BraKet braket,
+                         const std::array<Shell, 4>& s, double min_time,
+                         double& sink) {
+    typedef std::chrono::high_resolution_clock clock;
+    const auto& buf = engine.results();
+    auto compute = [&]() {
+      if (braket == BraKet::x_x)
+        engine.compute(s[0], s[1]);
+      else
+        engine.compute(s[0], s[1], s[2], s[3]);
+    };
+
+    compute();  // warm up
+    ClassTiming result;
+    result.nshellsets = engine.nshellsets();
+    result.nints = s[0].size() * s[1].size() * (braket == BraKet::x_x ? 1 : s[2].size() * s[3].size());
+
+    size_t ncalls = 0;
+    size_t nbatch = 1;
+    const auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+      for (size_t i = 0; i != nbatch; ++i) {
+        compute();
+        if (buf[0] != nullptr) sink += buf[0][0];
+      }
+      ncalls += nbatch;
+      nbatch *= 2;
+      elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < min_time);
+
+    result.ncalls = ncalls;
+    result.seconds = elapsed;
+    return result;
+  }
+
+  void write_json(std::ostream& os, const ClassTiming& t, Operator oper,
+                  BraKet braket, int deriv_order, bool first) {
+    if (!first) os << "," << std::endl;
+    const double calls_per_s = t.ncalls / t.seconds;
+    os << "    {\"operator\": \"" << to_string(oper) << "\""
+       << ", \"braket\": \"" << to_string(braket) << "\""
+       << ", \"deriv_order\": " << deriv_order
+       << ", \"class\": \"" << t.label << "\""
+       << ", \"l\": [" << t.l[0] << ", " << t.l[1] << ", " << t.l[2] << ", " << t.l[3] << "]"
+       << ", \"nshellsets\": " << t.nshellsets
+       << ", \"ncalls\": " << t.ncalls
+       << ", \"seconds\": " << t.seconds
+       << ", \"calls_per_second\": " << calls_per_s
+       << ", \"shellsets_per_second\": " << calls_per_s * t.nshellsets
+       << ", \"integrals_per_second\": " << calls_per_s * t.nints * t.nshellsets
+       << "}";
+  }
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  const int max_l_requested = (argc > 1) ? atoi(argv[1]) : LIBINT2_MAX_AM;
+  const size_t nprim = (argc > 2) ? atoi(argv[2]) : 3;
+  const bool pure = (argc > 3) ? atoi(argv[3]) != 0 : true;
+  const double min_time = (argc > 4) ? atof(argv[4]) : 0.1;
+  std::ofstream ofile;
+  if (argc > 5) ofile.open(argv[5]);
+  std::ostream& os = (argc > 5) ? ofile : std::cout;
+
+  if (max_l_requested < 0 || nprim == 0 || min_time <= 0.0) {
+    std::cerr << "usage: " << argv[0] << " [max_l] [nprim] [pure] [min_time] [output.json]" << std::endl;
+    return 1;
+  }
+
+  libint2::initialize();
+
+  // centers are well separated so that nothing is screened out
+  const std::array<std::array<double, 3>, 4> centers{{
+      {{0.0, 0.0, 0.0}}, {{0.0, 1.4, 1.1}}, {{1.2, -0.3, 0.4}}, {{-0.7, 0.5, -1.6}}}};
+
+  double sink = 0.0;
+  bool first = true;
+
+  os << "{" << std::endl
+     << "  \"libint_version\": \"" << LIBINT_VERSION << "\"," << std::endl
+     << "  \"max_l\": " << max_l_requested << "," << std::endl
+     << "  \"nprim\": " << nprim << "," << std::endl
+     << "  \"pure\": " << (pure ? "true" : "false") << "," << std::endl
+     << "  \"min_time\": " << min_time << "," << std::endl
+     << "  \"results\": [" << std::endl;
+
+  for (int o = static_cast<int>(Operator::first_oper);
+       o <= static_cast<int>(Operator::last_oper); ++o) {
+    const auto oper = static_cast<Operator>(o);
+    const auto first_braket = libint2::rank(oper) == 1 ? BraKet::first_1body_braket
+                                                        : BraKet::first_2body_braket;
+    const auto last_braket = libint2::rank(oper) == 1 ? BraKet::last_1body_braket
+                                                       : BraKet::last_2body_braket;
+    for (int b = static_cast<int>(first_braket); b <= static_cast<int>(last_braket); ++b) {
+      const auto braket = static_cast<BraKet>(b);
+      const int max_deriv = std::min(max_deriv_order(braket), LIBINT2_MAX_DERIV_ORDER);
+      for (int d = 0; d <= max_deriv; ++d) {
+
+        // find the largest angular momentum this combination supports
+        Engine engine;
+        int max_l = max_l_requested;
+        for (; max_l >= 0; --max_l) {
+          try {
+            engine = Engine(oper, nprim, max_l, d, std::numeric_limits<double>::epsilon(),
+                            bench_params(oper), braket);
+            break;
+          } catch (Engine::lmax_exceeded&) {
+          }
+        }
+        if (max_l < 0) continue;
+
+        // xs positions are occupied by the unit shell
+        const bool unit1 = (braket == BraKet::xs_xx || braket == BraKet::xs_xs);
+        const bool unit3 = (braket == BraKet::xx_xs || braket == BraKet::xs_xs);
+        const int lmax1 = unit1 ? 0 : max_l;
+        const int lmax2 = (braket == BraKet::x_x) ? 0 : max_l;
+        const int lmax3 = (unit3 || braket == BraKet::x_x) ? 0 : max_l;
+
+        std::array<int, 4> l;
+        for (l[0] = 0; l[0] <= max_l; ++l[0]) {
+          for (l[1] = 0; l[1] <= lmax1; ++l[1]) {
+            for (l[2] = 0; l[2] <= lmax2; ++l[2]) {
+              for (l[3] = 0; l[3] <= lmax3; ++l[3]) {
+                std::array<Shell, 4> s;
+                s[0] = make_shell(l[0], nprim, pure, centers[0]);
+                s[1] = unit1 ? Shell::unit() : make_shell(l[1], nprim, pure, centers[1]);
+                if (braket != BraKet::x_x) {
+                  s[2] = make_shell(l[2], nprim, pure, centers[2]);
+                  s[3] = unit3 ? Shell::unit() : make_shell(l[3], nprim, pure, centers[3]);
+                }
+
+                auto timing = time_class(engine, braket, s, min_time, sink);
+                timing.l = l;
+                timing.label = class_label(braket, l);
+                write_json(os, timing, oper, braket, d, first);
+                first = false;
+              }
+            }
+          }
+        }
+
+      }
+    }
+  }
+
+  os << std::endl << "  ]," << std::endl
+     << "  \"checksum\": " << sink << std::endl
+     << "}" << std::endl;
+
+  libint2::finalize();
+
+  return 0;
+}
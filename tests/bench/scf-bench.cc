@@ -0,0 +1,465 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/// This program benchmarks complete Hartree-Fock Fock builds on a ladder of generated
+/// systems (water clusters, linear alkanes, and hydrogen-terminated graphene flakes of
+/// increasing size), for several basis sets and thread counts. For each run the time spent
+/// in each phase (shell pairs, one-body integrals, Schwarz bounds, Fock build, reduction of
+/// the thread-local contributions, DIIS, diagonalization, etc.) is recorded, so that
+/// strong-scaling (fixed system, varying # of threads) and weak-scaling (system size
+/// proportional to the # of threads) curves can be extracted from a single output file.
+/// The results are written in JSON format.
+///
+/// The integrals and the Fock matrices are computed by the builders of hartree-fock++
+/// (see tests/hartree-fock/hartree-fock++.h), so that the benchmarked code is the tested
+/// code. A fixed number of SCF iterations is performed, starting from the core Hamiltonian
+/// guess; the energies are reported only to make sure that the runs being compared did the
+/// same work.
+///
+/// usage: scf-bench [systems] [sizes] [bases] [threads] [methods] [dfbasis] [niter] [output.json]
+///   systems : comma-separated list of system families: water, alkane, graphene
+///             (default = water,alkane,graphene)
+///   sizes   : comma-separated list of sizes; size n means n water molecules, C_n H_{2n+2}, or
+///             an n x n flake of hexagonal rings (default = 1,2,3)
+///   bases   : comma-separated list of orbital basis sets (default = sto-3g,6-31g*)
+///   threads : comma-separated list of thread counts (default = powers of 2 up to the # of cores)
+///   methods : comma-separated list of Fock builders: conventional, df, deriv
+///             (default = conventional,df,deriv); df requires the BTAS library, as in
+///             hartree-fock++; deriv follows the conventional SCF by the two-body
+///             contribution to the nuclear gradient
+///   dfbasis : density-fitting basis set (default = cc-pvdz-ri)
+///   niter   : the number of SCF iterations (default = 5)
+///   output  : the name of the JSON file (default = standard output)
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Eigen matrix algebra library
+#include <Eigen/Cholesky>
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+#include <libint2/diis.h>
+#include <libint2.hpp>
+
+// the integral and Fock matrix builders of hartree-fock++
+#include "hartree-fock++.h"
+
+namespace {
+
+  /// contributions to the Fock matrix smaller than this are neglected
+  const auto fock_precision = 1e-11;
+
+  const double angstrom_to_bohr = 1 / 0.52917721067;
+
+  typedef std::chrono::high_resolution_clock clock;
+
+  /// seconds elapsed since \c start
+  double seconds_since(const clock::time_point& start) {
+    return std::chrono::duration<double>(clock::now() - start).count();
+  }
+
+  /// accumulates the time spent in each phase, preserving the order in which phases first appear
+  class PhaseTimings {
+    public:
+      void add(const std::string& phase, double seconds) {
+        for (auto& p : phases_)
+          if (p.first == phase) {
+            p.second += seconds;
+            return;
+          }
+        phases_.emplace_back(phase, seconds);
+      }
+      const std::vector<std::pair<std::string, double>>& phases() const { return phases_; }
+    private:
+      std::vector<std::pair<std::string, double>> phases_;
+  };
+
+  std::vector<std::string> split(const std::string& str, char delim = ',') {
+    std::vector<std::string> result;
+    std::istringstream iss(str);
+    std::string token;
+    while (std::getline(iss, token, delim))
+      if (!token.empty()) result.push_back(token);
+    return result;
+  }
+
+  /// adds an atom, with coordinates given in angstrom
+  void add_atom(std::vector<Atom>& atoms, int Z, double x, double y, double z) {
+    atoms.push_back(Atom{Z, x * angstrom_to_bohr, y * angstrom_to_bohr, z * angstrom_to_bohr});
+  }
+
+  /// \c n water molecules on a cubic grid
+  std::vector<Atom> make_water_cluster(size_t n) {
+    std::vector<Atom> atoms;
+    const size_t m = std::ceil(std::cbrt(static_cast<double>(n)) - 1e-10);
+    const double spacing = 2.9;
+    for (size_t w = 0; w != n; ++w) {
+      const double x = spacing * (w % m);
+      const double y = spacing * ((w / m) % m);
+      const double z = spacing * (w / (m * m));
+      add_atom(atoms, 8, x, y, z);
+      add_atom(atoms, 1, x + 0.757, y + 0.586, z);
+      add_atom(atoms, 1, x - 0.757, y + 0.586, z);
+    }
+    return atoms;
+  }
+
+  /// all-trans linear alkane C_n H_{2n+2}
+  std::vector<Atom> make_alkane(size_t n) {
+    std::vector<Atom> atoms;
+    // zigzag backbone in the xy plane, C-C = 1.54, C-H = 1.09
+    const double dx = 1.27, dy = 0.44;
+    auto carbon = [=](long i) {
+      const double s = (i % 2 == 0) ? 1.0 : -1.0;
+      return std::array<double, 3>{{dx * i, dy * s, 0.0}};
+    };
+    // terminal H points toward where the next carbon would be
+    auto add_terminal_h = [&](long i, long i_virtual) {
+      const auto c = carbon(i);
+      const auto v = carbon(i_virtual);
+      const double r[3] = {v[0] - c[0], v[1] - c[1], v[2] - c[2]};
+      const double scale = 1.09 / std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+      add_atom(atoms, 1, c[0] + r[0] * scale, c[1] + r[1] * scale, c[2] + r[2] * scale);
+    };
+    for (long i = 0; i != static_cast<long>(n); ++i) {
+      const auto c = carbon(i);
+      const double s = (i % 2 == 0) ? 1.0 : -1.0;
+      add_atom(atoms, 6, c[0], c[1], c[2]);
+      add_atom(atoms, 1, c[0], c[1] + 0.63 * s, 0.89);
+      add_atom(atoms, 1, c[0], c[1] + 0.63 * s, -0.89);
+      if (i == 0) add_terminal_h(i, i - 1);
+      if (i == static_cast<long>(n) - 1) add_terminal_h(i, i + 1);
+    }
+    return atoms;
+  }
+
+  /// \c n x \c n parallelogram of hexagonal rings (C_{2(n+1)^2-2} H_{4n+2}), edges terminated by hydrogens
+  std::vector<Atom> make_graphene_flake(size_t n) {
+    const double rcc = 1.42;
+    const double a = rcc * std::sqrt(3.0);
+    const double pi = std::acos(-1.0);
+    std::vector<std::array<double, 3>> carbons;
+    for (size_t i = 0; i != n; ++i) {
+      for (size_t j = 0; j != n; ++j) {
+        const double cx = a * i + 0.5 * a * j;
+        const double cy = 0.5 * std::sqrt(3.0) * a * j;
+        for (int v = 0; v != 6; ++v) {
+          const double phi = pi / 6 + v * pi / 3;
+          const std::array<double, 3> r{{cx + rcc * std::cos(phi), cy + rcc * std::sin(phi), 0.0}};
+          bool is_new = true;
+          for (const auto& c : carbons)
+            if (std::abs(c[0] - r[0]) < 0.1 && std::abs(c[1] - r[1]) < 0.1) {
+              is_new = false;
+              break;
+            }
+          if (is_new) carbons.push_back(r);
+        }
+      }
+    }
+    std::vector<Atom> atoms;
+    for (const auto& c : carbons) add_atom(atoms, 6, c[0], c[1], c[2]);
+    // terminate 2-coordinated carbons by hydrogens, C-H = 1.09
+    for (const auto& c : carbons) {
+      double r[3] = {0.0, 0.0, 0.0};
+      int nneighbors = 0;
+      for (const auto& d : carbons) {
+        const double dx = d[0] - c[0], dy = d[1] - c[1];
+        const double dist = std::sqrt(dx * dx + dy * dy);
+        if (dist > 0.1 && dist < 1.6) {
+          r[0] -= dx;
+          r[1] -= dy;
+          ++nneighbors;
+        }
+      }
+      if (nneighbors == 2) {
+        const double scale = 1.09 / std::sqrt(r[0] * r[0] + r[1] * r[1]);
+        add_atom(atoms, 1, c[0] + r[0] * scale, c[1] + r[1] * scale, 0.0);
+      }
+    }
+    return atoms;
+  }
+
+  std::vector<Atom> make_system(const std::string& family, size_t size) {
+    if (family == "water") return make_water_cluster(size);
+    if (family == "alkane") return make_alkane(size);
+    if (family == "graphene") return make_graphene_flake(size);
+    throw std::invalid_argument(std::string("unknown system family ") + family);
+  }
+
+  double nuclear_repulsion_energy(const std::vector<Atom>& atoms) {
+    auto enuc = 0.0;
+    for (size_t i = 0; i < atoms.size(); i++)
+      for (size_t j = i + 1; j < atoms.size(); j++) {
+        auto xij = atoms[i].x - atoms[j].x;
+        auto yij = atoms[i].y - atoms[j].y;
+        auto zij = atoms[i].z - atoms[j].z;
+        enuc += atoms[i].atomic_number * atoms[j].atomic_number /
+                std::sqrt(xij * xij + yij * yij + zij * zij);
+      }
+    return enuc;
+  }
+
+
+  struct RunResult {
+    size_t nbf;
+    size_t nshells;
+    size_t nshellpairs;
+    double energy;
+    double gradient_norm;
+    PhaseTimings timings;
+  };
+
+  /// for its lifetime, routes the phase timings reported by the builders to \c timings ,
+  /// and redirects std::cout, where the builders and BasisSet report their progress
+  /// and which may be where the results go, to std::cerr
+  class BuilderReports {
+    public:
+      explicit BuilderReports(PhaseTimings& timings)
+          : coutbuf_(std::cout.rdbuf(std::cerr.rdbuf())) {
+        report_phase = [&timings](const char* phase, double seconds) {
+          timings.add(phase, seconds);
+        };
+      }
+      ~BuilderReports() {
+        report_phase = nullptr;
+        std::cout.rdbuf(coutbuf_);
+      }
+    private:
+      std::streambuf* coutbuf_;
+  };
+
+  /// runs \c niter SCF iterations for \c atoms in basis \c basisname using the given Fock builder
+  RunResult run_scf(const std::vector<Atom>& atoms, const std::string& basisname,
+                    const std::string& method, const std::string& dfbasisname, int niter) {
+    RunResult result;
+    result.gradient_norm = 0.0;
+    auto& timings = result.timings;
+    BuilderReports reports(timings);
+
+    const BasisSet obs(basisname, atoms);
+    result.nbf = obs.nbf();
+    result.nshells = obs.size();
+
+    auto nelectron = 0;
+    for (const auto& a : atoms) nelectron += a.atomic_number;
+    const auto ndocc = nelectron / 2;
+
+    // N.B. the one-body integrals are computed for the non-negligible shell pairs only
+    auto start = clock::now();
+    std::tie(obs_shellpair_list, obs_shellpair_data) = compute_shellpairs(obs);
+    timings.add("shellpairs", seconds_since(start));
+    result.nshellpairs = 0;
+    for (const auto& l : obs_shellpair_list) result.nshellpairs += l.second.size();
+
+    start = clock::now();
+    Matrix S = compute_1body_ints<Operator::overlap>(obs)[0];
+    Matrix H = compute_1body_ints<Operator::kinetic>(obs)[0];
+    H += compute_1body_ints<Operator::nuclear>(obs, libint2::make_point_charges(atoms))[0];
+    timings.add("onebody", seconds_since(start));
+
+    start = clock::now();
+    auto K = compute_schwarz_ints<>(obs);
+    timings.add("schwarz", seconds_since(start));
+
+#if HAVE_DENSITY_FITTING
+    BasisSet dfbs;
+    std::unique_ptr<DFFockEngine> dffockengine;
+    if (method == "df") {
+      dfbs = BasisSet(dfbasisname, atoms);
+      dffockengine.reset(new DFFockEngine(obs, dfbs));
+    }
+#else
+    if (method == "df")
+      throw std::runtime_error("density fitting requires the BTAS library");
+#endif
+
+    // canonical orthogonalizer
+    start = clock::now();
+    Eigen::SelfAdjointEigenSolver<Matrix> S_eig(S);
+    const auto& s = S_eig.eigenvalues();
+    long nkept = 0;
+    for (long i = 0; i != s.size(); ++i)
+      if (s(i) > 1e-8) ++nkept;
+    Matrix X = S_eig.eigenvectors().rightCols(nkept) *
+               s.tail(nkept).cwiseSqrt().cwiseInverse().asDiagonal();
+
+    // core Hamiltonian guess
+    auto diagonalize = [&](const Matrix& F, Matrix& C_occ, Matrix& D) {
+      Eigen::SelfAdjointEigenSolver<Matrix> eig_solver(X.transpose() * F * X);
+      C_occ = (X * eig_solver.eigenvectors()).leftCols(ndocc);
+      D = C_occ * C_occ.transpose();
+    };
+    Matrix C_occ, D;
+    diagonalize(H, C_occ, D);
+    timings.add("diag", seconds_since(start));
+
+    // the Fock builders report the "fock" and "reduction" phases (and, for density
+    // fitting, the setup phases) themselves
+    libint2::DIIS<Matrix> diis(2);
+    double ehf = 0.0;
+    for (int iter = 0; iter != niter; ++iter) {
+      Matrix F = H;
+#if HAVE_DENSITY_FITTING
+      if (dffockengine)
+        F += dffockengine->compute_2body_fock_dfC(C_occ);
+      else
+#endif
+        F += compute_2body_fock(obs, D, fock_precision, K);
+      ehf = D.cwiseProduct(H + F).sum();
+
+      start = clock::now();
+      Matrix FD_comm = F * D * S - S * D * F;
+      diis.extrapolate(F, FD_comm);
+      timings.add("diis", seconds_since(start));
+
+      start = clock::now();
+      diagonalize(F, C_occ, D);
+      timings.add("diag", seconds_since(start));
+    }
+    result.energy = ehf + nuclear_repulsion_energy(atoms);
+
+    if (method == "deriv") {
+#if LIBINT2_DERIV_ERI_ORDER
+      result.gradient_norm = compute_2body_gradient(obs, atoms, D, fock_precision, K).norm();
+#else
+      throw std::runtime_error("library does not support ERI derivatives");
+#endif
+    }
+
+    return result;
+  }
+
+  std::string json_escape(const std::string& str) {
+    std::string result;
+    for (const auto& c : str) {
+      if (c == '"' || c == '\\') result += '\\';
+      result += c;
+    }
+    return result;
+  }
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  const auto systems = split((argc > 1) ? argv[1] : "water,alkane,graphene");
+  const auto sizes = split((argc > 2) ? argv[2] : "1,2,3");
+  const auto bases = split((argc > 3) ? argv[3] : "sto-3g,6-31g*");
+  std::vector<int> thread_counts;
+  if (argc > 4) {
+    for (const auto& t : split(argv[4])) thread_counts.push_back(atoi(t.c_str()));
+  } else {
+    const int ncores = std::max(1u, std::thread::hardware_concurrency());
+    for (int t = 1; t <= ncores; t *= 2) thread_counts.push_back(t);
+  }
+  const auto methods = split((argc > 5) ? argv[5] : "conventional,df,deriv");
+  const std::string dfbasisname = (argc > 6) ? argv[6] : "cc-pvdz-ri";
+  const int niter = (argc > 7) ? atoi(argv[7]) : 5;
+  std::ofstream ofile;
+  if (argc > 8) ofile.open(argv[8]);
+  std::ostream& os = (argc > 8) ? ofile : std::cout;
+
+  bool valid_args = niter > 0 && !thread_counts.empty();
+  for (const auto& t : thread_counts) valid_args = valid_args && t > 0;
+  for (const auto& m : methods)
+    valid_args = valid_args && (m == "conventional" || m == "df" || m == "deriv");
+  if (!valid_args) {
+    std::cerr << "usage: " << argv[0]
+              << " [systems] [sizes] [bases] [threads] [methods] [dfbasis] [niter] [output.json]"
+              << std::endl;
+    return 1;
+  }
+
+  libint2::initialize();
+  libint2::Shell::do_enforce_unit_normalization(false);
+
+  os << "{" << std::endl
+     << "  \"libint_version\": \"" << LIBINT_VERSION << "\"," << std::endl
+     << "  \"niter\": " << niter << "," << std::endl
+     << "  \"dfbasis\": \"" << json_escape(dfbasisname) << "\"," << std::endl
+     << "  \"runs\": [" << std::endl;
+  os.precision(12);
+
+  bool first = true;
+  for (const auto& family : systems) {
+    for (const auto& size_str : sizes) {
+      const size_t size = atoi(size_str.c_str());
+      const auto atoms = make_system(family, size);
+      for (const auto& basisname : bases) {
+        for (const auto& method : methods) {
+          for (const auto& nthreads : thread_counts) {
+            libint2::nthreads = nthreads;
+#if defined(_OPENMP)
+            omp_set_num_threads(nthreads);
+#endif
+
+            if (!first) os << "," << std::endl;
+            first = false;
+            os << "    {\"system\": \"" << family << "\""
+               << ", \"size\": " << size
+               << ", \"natoms\": " << atoms.size()
+               << ", \"basis\": \"" << json_escape(basisname) << "\""
+               << ", \"method\": \"" << method << "\""
+               << ", \"nthreads\": " << nthreads;
+
+            try {
+              const auto start = clock::now();
+              const auto r = run_scf(atoms, basisname, method, dfbasisname, niter);
+              const auto wall = seconds_since(start);
+              os << ", \"nbf\": " << r.nbf
+                 << ", \"nshells\": " << r.nshells
+                 << ", \"nshellpairs\": " << r.nshellpairs
+                 << ", \"energy\": " << r.energy;
+              if (method == "deriv") os << ", \"gradient_norm\": " << r.gradient_norm;
+              os << ", \"seconds\": {";
+              for (const auto& p : r.timings.phases())
+                os << "\"" << p.first << "\": " << p.second << ", ";
+              os << "\"total\": " << wall << "}}";
+            }
+            catch (std::exception& ex) {  // e.g. basis set not available, or max L exceeded
+              os << ", \"skipped\": \"" << json_escape(ex.what()) << "\"}";
+            }
+            os.flush();
+          }
+        }
+      }
+    }
+  }
+
+  os << std::endl << "  ]" << std::endl
+     << "}" << std::endl;
+
+  libint2::finalize();
+
+  return 0;
+}
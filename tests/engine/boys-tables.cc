@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/// This program prebuilds the interpolation tables of the Boys function
+/// evaluators, FmEval_Chebyshev7 and FmEval_Taylor, and writes them to the
+/// directory named by the LIBINT_BOYS_TABLE_PATH environmental variable.
+/// Programs that are run with the same LIBINT_BOYS_TABLE_PATH then map the
+/// tables from there instead of computing them.
+///
+/// usage: LIBINT_BOYS_TABLE_PATH=dir boys-tables [mmax] [precision]
+///   mmax      : the maximum Boys function index (default = enough for the
+///               integrals and derivatives supported by the library)
+///   precision : the precision of the Taylor interpolation table
+///               (default = the machine epsilon, as used by Engine)
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#include <libint2.hpp>
+
+int main(int argc, char* argv[]) {
+  using std::cout;
+  using std::cerr;
+  using std::endl;
+
+  const int mmax =
+      (argc > 1) ? atoi(argv[1])
+                 : std::min(4 * LIBINT2_MAX_AM + LIBINT2_MAX_DERIV_ORDER + 1, 63);
+  const double precision =
+      (argc > 2) ? atof(argv[2]) : std::numeric_limits<double>::epsilon();
+  if (libint2::detail::MappedTable::path().empty() || mmax < 0 || mmax > 63 ||
+      precision <= 0.0) {
+    cerr << "usage: LIBINT_BOYS_TABLE_PATH=dir " << argv[0]
+         << " [mmax] [precision]" << endl;
+    return 1;
+  }
+
+  libint2::FmEval_Chebyshev7<double> cheb7(mmax);
+  const auto cheb7_saved = cheb7.save_table();
+  cout << libint2::FmEval_Chebyshev7<double>::table_filename()
+       << (cheb7_saved ? "" : ": failed") << endl;
+
+  libint2::FmEval_Taylor<double> taylor(mmax, precision);
+  const auto taylor_saved = taylor.save_table();
+  cout << libint2::FmEval_Taylor<double>::table_filename()
+       << (taylor_saved ? "" : ": failed") << endl;
+
+  return cheb7_saved && taylor_saved ? 0 : 1;
+}
@@ -0,0 +1,648 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/// This program tests the options of libint2::Engine by comparing the integrals
+/// that it computes with the same integrals computed in another way, e.g.
+/// with the option turned off
+
+// the consistency checks in Engine are part of the test
+#ifdef NDEBUG
+# undef NDEBUG
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <libint2.hpp>
+
+#if defined(LIBINT2_HAVE_MMAP)
+# include <unistd.h>
+#endif
+
+using namespace std;
+using namespace libint2;
+
+namespace {
+
+  /// water, in a frame without symmetry
+  std::vector<Atom> make_h2o() {
+    return {{8, 0.1, -0.2, 0.05}, {1, 1.5, 1.0, 0.3}, {1, -1.4, 1.2, -0.4}};
+  }
+
+  const char* braket_label(BraKet braket) {
+    switch (braket) {
+      case BraKet::xx_xx: return "xx_xx";
+      case BraKet::xs_xx: return "xs_xx";
+      case BraKet::xx_xs: return "xx_xs";
+      case BraKet::xs_xs: return "xs_xs";
+      default: return "?";
+    }
+  }
+
+  const char* oper_label(Operator oper) {
+    switch (oper) {
+      case Operator::coulomb: return "coulomb";
+      case Operator::cgtg: return "cgtg";
+      case Operator::cgtg_x_coulomb: return "cgtg_x_coulomb";
+      case Operator::delcgtg2: return "delcgtg2";
+      default: return "?";
+    }
+  }
+
+  /// the geminal of the tests of the Gaussian geminal operators
+  const ContractedGaussianGeminal& test_geminal() {
+    static const ContractedGaussianGeminal geminal{
+        {0.2, 0.3}, {1.0, 0.4}, {5.0, 0.3}};
+    return geminal;
+  }
+
+  /// @return true if shell sets \c n -long \c a and \c b are bitwise equal
+  template <typename Real>
+  bool bitwise_equal(const Real* a, const Real* b, size_t n) {
+    if (a == nullptr || b == nullptr) return a == b;
+    return std::equal(a, a + n, b);
+  }
+
+  /// loops over the shell quartets of \c obs appropriate for \c braket
+  /// (the unit shell stands in for the missing centers) and calls
+  /// \c op(s1,s2,s3,s4)
+  template <typename Op>
+  void foreach_quartet(const BasisSet& obs, BraKet braket, Op op) {
+    const auto nsh = obs.size();
+    const auto& unit = Shell::unit();
+    const bool unit2 = braket == BraKet::xs_xx || braket == BraKet::xs_xs;
+    const bool unit4 = braket == BraKet::xx_xs || braket == BraKet::xs_xs;
+    for (size_t s1 = 0; s1 != nsh; ++s1)
+      for (size_t s2 = 0; s2 != (unit2 ? 1 : nsh); ++s2)
+        for (size_t s3 = 0; s3 != nsh; ++s3)
+          for (size_t s4 = 0; s4 != (unit4 ? 1 : nsh); ++s4)
+            op(obs[s1], unit2 ? unit : obs[s2], obs[s3], unit4 ? unit : obs[s4]);
+  }
+
+  /// computes shell set (s1 s2|s3 s4) with \c engine ; the unit shells that
+  /// stand in for the missing centers of \c braket are not passed to it
+  void compute(Engine& engine, BraKet braket, const Shell& s1, const Shell& s2,
+               const Shell& s3, const Shell& s4) {
+    switch (braket) {
+      case BraKet::xs_xx: engine.compute(s1, s3, s4); break;
+      case BraKet::xx_xs: engine.compute(s1, s2, s3); break;
+      case BraKet::xs_xs: engine.compute(s1, s3); break;
+      default: engine.compute(s1, s2, s3, s4);
+    }
+  }
+
+}  // anonymous namespace
+
+bool test_unique_derivatives(BraKet braket, int deriv_order);
+bool test_rs_coulomb(int deriv_order);
+bool test_shell_views();
+bool test_compute_and_copy();
+bool test_general_contractions(Operator oper, libint2::any params);
+template <int k> bool test_gaussian_gm_eval();
+bool test_boys_tables();
+
+int main(int argc, char* argv[]) {
+  libint2::initialize();
+
+  bool ok = true;
+  ok = test_boys_tables() && ok;
+  ok = test_gaussian_gm_eval<0>() && ok;
+  ok = test_gaussian_gm_eval<-1>() && ok;
+  ok = test_gaussian_gm_eval<2>() && ok;
+#if LIBINT2_SUPPORT_ONEBODY && LIBINT2_SUPPORT_ERI
+  ok = test_shell_views() && ok;
+  ok = test_compute_and_copy() && ok;
+#endif
+#if LIBINT2_SUPPORT_ERI
+  ok = test_general_contractions(Operator::coulomb,
+                                 default_params(Operator::coulomb)) &&
+       ok;
+  // the core ints of the Gaussian geminal operators are evaluated in batches
+  // over the primitive quartets for segmented shells, but one quartet at a
+  // time for general shells, hence this also tests the batched evaluation
+  for (auto oper :
+       {Operator::cgtg, Operator::cgtg_x_coulomb, Operator::delcgtg2})
+    ok = test_general_contractions(oper, test_geminal()) && ok;
+  for (int d = 1; d <= std::min(LIBINT2_DERIV_ERI_ORDER, 2); ++d)
+    ok = test_unique_derivatives(BraKet::xx_xx, d) && ok;
+  for (int d = 0; d <= std::min(LIBINT2_DERIV_ERI_ORDER, 1); ++d)
+    ok = test_rs_coulomb(d) && ok;
+#endif
+#if LIBINT2_SUPPORT_ERI3
+  for (int d = 1; d <= std::min(LIBINT2_DERIV_ERI3_ORDER, 2); ++d)
+    ok = test_unique_derivatives(BraKet::xs_xx, d) && ok;
+#endif
+#if LIBINT2_SUPPORT_ERI2
+  for (int d = 1; d <= std::min(LIBINT2_DERIV_ERI2_ORDER, 2); ++d)
+    ok = test_unique_derivatives(BraKet::xs_xs, d) && ok;
+#endif
+
+  libint2::finalize();
+  return ok ? 0 : 1;
+}
+
+/// compares the translationally-unique derivatives, see
+/// Engine::set_unique_derivatives(), with the corresponding subset of all
+/// derivatives
+bool test_unique_derivatives(BraKet braket, int deriv_order) {
+  const auto atoms = make_h2o();
+  // use the largest basis (with pure d functions, if possible) that the
+  // library supports for this derivative order
+  for (auto basis_name : {"cc-pVDZ", "6-31G"}) {
+    BasisSet obs(basis_name, atoms);
+    obs.set_pure(true);
+    Engine full, unique;
+    try {
+      full = Engine(Operator::coulomb, obs.max_nprim(), obs.max_l(),
+                    deriv_order);
+      full.set_braket(braket);
+    } catch (Engine::lmax_exceeded&) {
+      continue;
+    }
+    // turn unique derivatives on after the construction, then copy
+    unique = full;
+    unique.set_unique_derivatives(true);
+    Engine unique_copy(unique);
+
+    const auto ncenters = braket == BraKet::xx_xx
+                              ? 4
+                              : (braket == BraKet::xs_xs ? 2 : 3);
+    const auto nderiv = num_geometrical_derivatives(ncenters, deriv_order);
+    const auto nderiv_unique =
+        num_geometrical_derivatives(ncenters - 1, deriv_order);
+    bool ok = full.nshellsets() == nderiv &&
+              unique.nshellsets() == nderiv_unique &&
+              unique_copy.nshellsets() == nderiv_unique;
+
+    const auto& buf_full = full.results();
+    const auto& buf_unique = unique.results();
+    const auto& buf_unique_copy = unique_copy.results();
+    foreach_quartet(obs, braket, [&](const Shell& s1, const Shell& s2,
+                                     const Shell& s3, const Shell& s4) {
+      if (!ok) return;
+      compute(full, braket, s1, s2, s3, s4);
+      compute(unique, braket, s1, s2, s3, s4);
+      compute(unique_copy, braket, s1, s2, s3, s4);
+      const auto n1234 = s1.size() * s2.size() * s3.size() * s4.size();
+      for (size_t d = 0; d != nderiv; ++d) {
+        const auto u = unique_geometrical_derivative_index(ncenters,
+                                                           deriv_order, d);
+        if (u < 0) continue;
+        ok = ok && bitwise_equal(buf_full[d], buf_unique[u], n1234) &&
+             bitwise_equal(buf_full[d], buf_unique_copy[u], n1234);
+      }
+    });
+
+    cout << "Testing unique derivatives (" << braket_label(braket)
+         << ", deriv order = " << deriv_order << ", " << basis_name
+         << "): " << (ok ? "ok" : "failed") << endl;
+    return ok;
+  }
+
+  cout << "Testing unique derivatives (" << braket_label(braket)
+       << ", deriv order = " << deriv_order
+       << "): skipped, angular momentum not supported" << endl;
+  return true;
+}
+
+/// compares the full-range and long-range integrals computed in one pass by
+/// Operator::rs_coulomb with those computed by the Operator::coulomb and
+/// Operator::erf_coulomb engines
+bool test_rs_coulomb(int deriv_order) {
+  const auto atoms = make_h2o();
+  const scalar_type omega = 0.4;
+  for (auto basis_name : {"cc-pVDZ", "6-31G"}) {
+    BasisSet obs(basis_name, atoms);
+    Engine rs, coulomb, erf_coulomb;
+    // no screening, so that the engines compute the same shell sets
+    try {
+      rs = Engine(Operator::rs_coulomb, obs.max_nprim(), obs.max_l(),
+                  deriv_order, 0., omega);
+      coulomb = Engine(Operator::coulomb, obs.max_nprim(), obs.max_l(),
+                       deriv_order, 0.);
+      erf_coulomb = Engine(Operator::erf_coulomb, obs.max_nprim(), obs.max_l(),
+                           deriv_order, 0., omega);
+    } catch (Engine::lmax_exceeded&) {
+      continue;
+    }
+
+    const auto nderiv = coulomb.nshellsets();
+    bool ok = rs.nshellsets() == 2 * nderiv &&
+              erf_coulomb.nshellsets() == nderiv;
+
+    const auto& buf_rs = rs.results();
+    const auto& buf_coulomb = coulomb.results();
+    const auto& buf_erf_coulomb = erf_coulomb.results();
+    foreach_quartet(obs, BraKet::xx_xx, [&](const Shell& s1, const Shell& s2,
+                                            const Shell& s3, const Shell& s4) {
+      if (!ok) return;
+      rs.compute(s1, s2, s3, s4);
+      coulomb.compute(s1, s2, s3, s4);
+      erf_coulomb.compute(s1, s2, s3, s4);
+      const auto n1234 = s1.size() * s2.size() * s3.size() * s4.size();
+      for (size_t d = 0; d != nderiv; ++d)
+        ok = ok && bitwise_equal(buf_coulomb[d], buf_rs[d], n1234) &&
+             bitwise_equal(buf_erf_coulomb[d], buf_rs[nderiv + d], n1234);
+    });
+
+    cout << "Testing rs_coulomb (deriv order = " << deriv_order << ", "
+         << basis_name << "): " << (ok ? "ok" : "failed") << endl;
+    return ok;
+  }
+
+  cout << "Testing rs_coulomb (deriv order = " << deriv_order
+       << "): skipped, angular momentum not supported" << endl;
+  return true;
+}
+
+/// compares the integrals over the views of a FlatBasisSet with those over
+/// the Shell objects it was made of
+bool test_shell_views() {
+  const auto atoms = make_h2o();
+  for (auto basis_name : {"cc-pVDZ", "6-31G"}) {
+    std::vector<Shell> shells = BasisSet(basis_name, atoms);
+    // append a generally-contracted sp shell
+    shells.push_back(Shell{{5.03, 1.17, 0.38},
+                           {{0, false, {-0.1, 0.4, 0.7}},
+                            {1, false, {0.16, 0.6, 0.39}}},
+                           {{atoms[0].x, atoms[0].y, atoms[0].z}}});
+    const FlatBasisSet views(shells);
+    const auto nsh = shells.size();
+
+    std::vector<Engine> engines_1body;
+    Engine engine_2body;
+    try {
+      for (auto oper : {Operator::overlap, Operator::kinetic,
+                        Operator::nuclear})
+        engines_1body.emplace_back(oper, views.max_nprim(), views.max_l(), 0);
+      engines_1body.back().set_params(make_point_charges(atoms));
+      // no screening, so that all shell sets are computed
+      engine_2body = Engine(Operator::coulomb, views.max_nprim(),
+                            views.max_l(), 0, 0.);
+    } catch (Engine::lmax_exceeded&) {
+      continue;
+    }
+
+    bool ok = views.size() == nsh;
+    for (auto& engine : engines_1body) {
+      const auto& buf = engine.results();
+      for (size_t s1 = 0; s1 != nsh; ++s1)
+        for (size_t s2 = 0; s2 != nsh; ++s2) {
+          const auto n12 = shells[s1].size() * shells[s2].size();
+          engine.compute(shells[s1], shells[s2]);
+          std::vector<scalar_type> ints(buf[0], buf[0] + n12);
+          engine.compute(views[s1], views[s2]);
+          ok = ok && bitwise_equal(ints.data(), buf[0], n12);
+        }
+    }
+
+    // precomputed shell pair data, from the shells and from the views
+    const auto ln_prec = std::numeric_limits<scalar_type>::lowest();
+    std::vector<ShellPair> shell_pairs, view_pairs;
+    for (size_t s1 = 0; s1 != nsh; ++s1)
+      for (size_t s2 = 0; s2 != nsh; ++s2) {
+        shell_pairs.emplace_back(shells[s1], shells[s2], ln_prec);
+        view_pairs.emplace_back(views[s1], views[s2], ln_prec);
+      }
+
+    const auto& buf = engine_2body.results();
+    std::vector<scalar_type> ints;
+    for (size_t s1 = 0; s1 != nsh && ok; ++s1)
+      for (size_t s2 = 0; s2 != nsh; ++s2)
+        for (size_t s3 = 0; s3 != nsh; ++s3)
+          for (size_t s4 = 0; s4 != nsh; ++s4) {
+            const auto n1234 = shells[s1].size() * shells[s2].size() *
+                               shells[s3].size() * shells[s4].size();
+            engine_2body.compute(shells[s1], shells[s2], shells[s3],
+                                 shells[s4]);
+            ints.assign(buf[0], buf[0] + n1234);
+            engine_2body.compute(views[s1], views[s2], views[s3], views[s4]);
+            ok = ok && bitwise_equal(ints.data(), buf[0], n1234);
+
+            const auto& sp12 = shell_pairs[s1 * nsh + s2];
+            const auto& sp34 = shell_pairs[s3 * nsh + s4];
+            engine_2body.compute2<Operator::coulomb, BraKet::xx_xx, 0>(
+                shells[s1], shells[s2], shells[s3], shells[s4], &sp12, &sp34);
+            ints.assign(buf[0], buf[0] + n1234);
+            const auto& vp12 = view_pairs[s1 * nsh + s2];
+            const auto& vp34 = view_pairs[s3 * nsh + s4];
+            engine_2body.compute2<Operator::coulomb, BraKet::xx_xx, 0>(
+                views[s1], views[s2], views[s3], views[s4], &vp12, &vp34);
+            ok = ok && bitwise_equal(ints.data(), buf[0], n1234);
+          }
+
+    cout << "Testing shell views (" << basis_name
+         << " + gencon): " << (ok ? "ok" : "failed") << endl;
+    return ok;
+  }
+
+  cout << "Testing shell views: skipped, angular momentum not supported"
+       << endl;
+  return true;
+}
+
+/// compares the shell sets that Engine::compute_and_copy() copies to strided
+/// storage, with scaling and accumulation, with those returned by
+/// Engine::compute()
+bool test_compute_and_copy() {
+  const auto atoms = make_h2o();
+  for (auto basis_name : {"cc-pVDZ", "6-31G"}) {
+    const BasisSet obs(basis_name, atoms);
+    const FlatBasisSet views(obs);
+    const auto nsh = obs.size();
+
+    Engine engine_1body, engine_2body;
+    try {
+      engine_1body = Engine(Operator::overlap, obs.max_nprim(), obs.max_l(), 0);
+      // no screening, so that all shell sets are computed
+      engine_2body =
+          Engine(Operator::coulomb, obs.max_nprim(), obs.max_l(), 0, 0.);
+    } catch (Engine::lmax_exceeded&) {
+      continue;
+    }
+
+    // 1-body: copy the shell sets to the blocks of row-major matrix M, and
+    // accumulate them twice, scaled by 1/2, to the transposed blocks of Mt
+    // (the scaling by powers of 2 is exact, hence Mt must equal M^T bitwise)
+    const size_t n = obs.nbf();
+    const auto shell2bf = obs.shell2bf();
+    std::vector<scalar_type> M(n * n, 0), Mt(n * n, 0);
+    for (size_t s1 = 0; s1 != nsh; ++s1)
+      for (size_t s2 = 0; s2 != nsh; ++s2) {
+        const auto bf1 = shell2bf[s1], bf2 = shell2bf[s2];
+        auto* dest = &M[bf1 * n + bf2];
+        engine_1body.compute_and_copy(&dest, {{n, 1, 0, 0}}, 1, false,
+                                      obs[s1], obs[s2]);
+        dest = &Mt[bf2 * n + bf1];
+        for (int rep = 0; rep != 2; ++rep)
+          engine_1body.compute_and_copy(&dest, {{1, n, 0, 0}}, 0.5, true,
+                                        views[s1], views[s2]);
+      }
+    bool ok = true;
+    const auto& buf_1body = engine_1body.results();
+    for (size_t s1 = 0; s1 != nsh; ++s1)
+      for (size_t s2 = 0; s2 != nsh; ++s2) {
+        engine_1body.compute(obs[s1], obs[s2]);
+        const auto n2 = obs[s2].size();
+        for (size_t f1 = 0; f1 != obs[s1].size(); ++f1)
+          for (size_t f2 = 0; f2 != n2; ++f2) {
+            const auto bf1 = shell2bf[s1] + f1, bf2 = shell2bf[s2] + f2;
+            ok = ok && M[bf1 * n + bf2] == buf_1body[0][f1 * n2 + f2] &&
+                 Mt[bf2 * n + bf1] == M[bf1 * n + bf2];
+          }
+      }
+
+    // 2-body: copy each shell set, negated, to a buffer with the function
+    // indices in {f3,f1,f4,f2} order
+    const auto& buf_2body = engine_2body.results();
+    std::vector<scalar_type> T;
+    for (size_t s1 = 0; s1 != nsh && ok; ++s1)
+      for (size_t s2 = 0; s2 != nsh; ++s2)
+        for (size_t s3 = 0; s3 != nsh; ++s3)
+          for (size_t s4 = 0; s4 != nsh; ++s4) {
+            const auto n1 = obs[s1].size(), n2 = obs[s2].size();
+            const auto n3 = obs[s3].size(), n4 = obs[s4].size();
+            T.assign(n1 * n2 * n3 * n4, 0);
+            auto* dest = T.data();
+            const std::array<size_t, 4> strides{
+                {n4 * n2, 1, n1 * n4 * n2, n2}};
+            engine_2body.compute_and_copy(&dest, strides, -1, false,
+                                          views[s1], views[s2], views[s3],
+                                          views[s4]);
+            engine_2body.compute(obs[s1], obs[s2], obs[s3], obs[s4]);
+            for (size_t f1 = 0, f1234 = 0; f1 != n1; ++f1)
+              for (size_t f2 = 0; f2 != n2; ++f2)
+                for (size_t f3 = 0; f3 != n3; ++f3)
+                  for (size_t f4 = 0; f4 != n4; ++f4, ++f1234)
+                    ok = ok && T[f1 * strides[0] + f2 * strides[1] +
+                                 f3 * strides[2] + f4 * strides[3]] ==
+                                   -buf_2body[0][f1234];
+          }
+
+    cout << "Testing compute_and_copy (" << basis_name
+         << "): " << (ok ? "ok" : "failed") << endl;
+    return ok;
+  }
+
+  cout << "Testing compute_and_copy: skipped, angular momentum not supported"
+       << endl;
+  return true;
+}
+
+/// compares the integrals over generally-contracted shells with those over
+/// the equivalent segmented shells, one per contraction; the primitive data
+/// is shared by the contractions in the former case only, hence the results
+/// agree to roundoff, not bitwise
+bool test_general_contractions(Operator oper, libint2::any params) {
+  const auto atoms = make_h2o();
+  // the generally-contracted shells, and for each the equivalent segmented
+  // shells, in the order of its contractions
+  std::vector<Shell> gencon;
+  std::vector<std::vector<Shell>> segmented;
+  auto add_shell = [&](std::vector<double> alpha,
+                       std::vector<Shell::Contraction> contr,
+                       const Atom& atom) {
+    const std::array<double, 3> O{{atom.x, atom.y, atom.z}};
+    gencon.push_back(Shell{alpha, contr, O});
+    segmented.emplace_back();
+    for (const auto& c : contr) segmented.back().push_back(Shell{alpha, {c}, O});
+  };
+  add_shell({5.03, 1.17, 0.38},
+            {{0, false, {-0.1, 0.4, 0.7}}, {1, false, {0.16, 0.6, 0.39}}},
+            atoms[0]);
+  add_shell({3.4, 0.62, 0.17},
+            {{0, false, {0.15, 0.53, 0.44}}, {0, false, {0.3, -0.2, 0.9}}},
+            atoms[1]);
+  add_shell({1.3, 0.41}, {{1, false, {0.5, 0.6}}, {2, true, {0.3, 0.8}}},
+            atoms[2]);
+
+  const auto nsh = gencon.size();
+  size_t max_nprim = 0;
+  int max_l = 0;
+  for (const auto& s : gencon) {
+    max_nprim = std::max(max_nprim, s.nprim());
+    for (const auto& c : s.contr) max_l = std::max(max_l, c.l);
+  }
+
+  Engine engine;
+  try {
+    // no screening, so that all shell sets are computed
+    engine = Engine(oper, max_nprim, max_l, 0, 0., params);
+  } catch (Engine::lmax_exceeded&) {
+    cout << "Testing general contractions (" << oper_label(oper)
+         << "): skipped, angular momentum not supported" << endl;
+    return true;
+  }
+
+  const scalar_type tolerance = 1e-12;
+  const auto& buf = engine.results();
+  std::vector<scalar_type> G;
+  bool ok = true;
+  scalar_type max_abs_error = 0;
+  for (size_t s1 = 0; s1 != nsh && ok; ++s1)
+    for (size_t s2 = 0; s2 != nsh && ok; ++s2)
+      for (size_t s3 = 0; s3 != nsh && ok; ++s3)
+        for (size_t s4 = 0; s4 != nsh && ok; ++s4) {
+          const auto n1 = gencon[s1].size(), n2 = gencon[s2].size();
+          const auto n3 = gencon[s3].size(), n4 = gencon[s4].size();
+          engine.compute(gencon[s1], gencon[s2], gencon[s3], gencon[s4]);
+          ok = buf[0] != nullptr;
+          if (!ok) continue;
+          G.assign(buf[0], buf[0] + n1 * n2 * n3 * n4);
+          // the functions of contraction c of a shell start at offset o
+          for (size_t c1 = 0, o1 = 0; c1 != segmented[s1].size();
+               o1 += segmented[s1][c1++].size())
+            for (size_t c2 = 0, o2 = 0; c2 != segmented[s2].size();
+                 o2 += segmented[s2][c2++].size())
+              for (size_t c3 = 0, o3 = 0; c3 != segmented[s3].size();
+                   o3 += segmented[s3][c3++].size())
+                for (size_t c4 = 0, o4 = 0; c4 != segmented[s4].size();
+                     o4 += segmented[s4][c4++].size()) {
+                  const auto& t1 = segmented[s1][c1];
+                  const auto& t2 = segmented[s2][c2];
+                  const auto& t3 = segmented[s3][c3];
+                  const auto& t4 = segmented[s4][c4];
+                  engine.compute(t1, t2, t3, t4);
+                  if (buf[0] == nullptr) {
+                    ok = false;
+                    continue;
+                  }
+                  for (size_t f1 = 0, f1234 = 0; f1 != t1.size(); ++f1)
+                    for (size_t f2 = 0; f2 != t2.size(); ++f2)
+                      for (size_t f3 = 0; f3 != t3.size(); ++f3)
+                        for (size_t f4 = 0; f4 != t4.size(); ++f4, ++f1234) {
+                          const auto g = G[(((o1 + f1) * n2 + o2 + f2) * n3 +
+                                            o3 + f3) * n4 + o4 + f4];
+                          max_abs_error = std::max(
+                              max_abs_error, std::abs(g - buf[0][f1234]));
+                        }
+                }
+        }
+  ok = ok && max_abs_error < tolerance;
+
+  cout << "Testing general contractions (" << oper_label(oper)
+       << "): " << (ok ? "ok" : "failed")
+       << " (max abs error = " << max_abs_error << ")" << endl;
+  return ok;
+}
+
+/// compares the core integrals of the Gaussian geminal operators evaluated by
+/// GaussianGmEval for a batch of (rho,T) pairs with those evaluated one pair
+/// at a time; the two evaluations group the arithmetic differently, hence
+/// agree to roundoff, not bitwise
+template <int k>
+bool test_gaussian_gm_eval() {
+  const int mmax = 8;
+  typedef GaussianGmEval<scalar_type, k> gm_eval_type;
+  auto gm_eval = gm_eval_type::instance(
+      mmax, std::numeric_limits<scalar_type>::epsilon());
+  detail::CoreEvalScratch<gm_eval_type> scratch(mmax);
+
+  std::vector<scalar_type> rho, T;
+  for (scalar_type r = 0.01; r < 100; r *= 2.3)
+    for (scalar_type t : {0.0, 1e-4, 0.3, 2.7, 11.0, 35.0, 120.0}) {
+      rho.push_back(r);
+      T.push_back(t);
+    }
+  const auto n = rho.size();
+  std::vector<scalar_type> Gm_batch(n * (mmax + 1)), Gm(mmax + 1);
+  gm_eval->eval(Gm_batch.data(), rho.data(), T.data(), n, mmax,
+                test_geminal(), &scratch);
+
+  const scalar_type tolerance = 1e-13;
+  scalar_type max_rel_error = 0;
+  for (size_t q = 0; q != n; ++q) {
+    gm_eval->eval(Gm.data(), rho[q], T[q], mmax, test_geminal(), &scratch);
+    for (int m = 0; m <= mmax; ++m) {
+      const auto error = std::abs(Gm_batch[q * (mmax + 1) + m] - Gm[m]);
+      if (error != 0)
+        max_rel_error = std::max(max_rel_error, error / std::abs(Gm[m]));
+    }
+  }
+  const bool ok = max_rel_error < tolerance;
+
+  cout << "Testing batched GaussianGmEval (k = " << k
+       << "): " << (ok ? "ok" : "failed")
+       << " (max rel error = " << max_rel_error << ")" << endl;
+  return ok;
+}
+
+/// saves the interpolation tables of the Boys function evaluators, maps them
+/// via LIBINT_BOYS_TABLE_PATH (see tests/engine/boys-tables.cc), and compares
+/// the values interpolated with the mapped tables with those interpolated with
+/// the tables built in-process
+bool test_boys_tables() {
+#if defined(LIBINT2_HAVE_MMAP)
+  char dir[] = "boys-tables.XXXXXX";
+  if (mkdtemp(dir) == nullptr) {
+    cout << "Testing mapped Boys tables: failed, cannot create directory"
+         << endl;
+    return false;
+  }
+  setenv("LIBINT_BOYS_TABLE_PATH", dir, 1);
+
+  const int mmax = 20;
+  const auto precision = std::numeric_limits<double>::epsilon();
+  bool ok;
+  {
+    const FmEval_Chebyshev7<double> cheb7(mmax);
+    const FmEval_Taylor<double> taylor(mmax, precision);
+    ok = !cheb7.mapped() && !taylor.mapped() && cheb7.save_table() &&
+         taylor.save_table();
+
+    // the tables also serve evaluators with smaller mmax and looser precision
+    for (int m : {mmax, mmax / 2}) {
+      const FmEval_Chebyshev7<double> cheb7_mapped(m);
+      const FmEval_Taylor<double> taylor_mapped(
+          m, m == mmax ? precision : 10 * precision);
+      ok = ok && cheb7_mapped.mapped() && taylor_mapped.mapped();
+      if (!ok) break;
+
+      std::vector<double> Fm(mmax + 1), Fm_mapped(mmax + 1);
+      for (double T = 0.0; T < 50.0 && ok; T += 0.0123) {
+        cheb7.eval(Fm.data(), T, m);
+        cheb7_mapped.eval(Fm_mapped.data(), T, m);
+        ok = bitwise_equal(Fm.data(), Fm_mapped.data(), m + 1);
+        taylor.eval(Fm.data(), T, m);
+        taylor_mapped.eval(Fm_mapped.data(), T, m);
+        ok = ok && bitwise_equal(Fm.data(), Fm_mapped.data(), m + 1);
+      }
+    }
+  }
+
+  std::remove(FmEval_Chebyshev7<double>::table_filename().c_str());
+  std::remove(FmEval_Taylor<double>::table_filename().c_str());
+  rmdir(dir);
+  unsetenv("LIBINT_BOYS_TABLE_PATH");
+
+  cout << "Testing mapped Boys tables: " << (ok ? "ok" : "failed") << endl;
+  return ok;
+#else
+  cout << "Testing mapped Boys tables: skipped, mmap not available" << endl;
+  return true;
+#endif
+}
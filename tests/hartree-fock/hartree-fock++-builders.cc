@@ -0,0 +1,755 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// the non-template integral and Fock matrix builders declared in
+// hartree-fock++.h
+
+// uncomment if want to report integral timings
+// N.B. integral engine timings are controled in engine.h
+#define REPORT_INTEGRAL_TIMINGS
+
+#include "hartree-fock++.h"
+
+shellpair_list_t obs_shellpair_list;
+shellpair_data_t obs_shellpair_data;
+
+namespace libint2 {
+int nthreads;
+}
+
+libint2::EnginePool& engine_pool() {
+  static std::unique_ptr<libint2::EnginePool> pool;
+  if (!pool || pool->nthreads() != size_t(libint2::nthreads))
+    pool.reset(new libint2::EnginePool(libint2::nthreads));
+  return *pool;
+}
+
+std::function<void(const char* phase, double seconds)> report_phase;
+
+Matrix compute_shellblock_norm(const BasisSet& obs, const Matrix& A) {
+  const auto nsh = obs.size();
+  Matrix Ash(nsh, nsh);
+
+  auto shell2bf = obs.shell2bf();
+  for (size_t s1 = 0; s1 != nsh; ++s1) {
+    const auto& s1_first = shell2bf[s1];
+    const auto& s1_size = obs[s1].size();
+    for (size_t s2 = 0; s2 != nsh; ++s2) {
+      const auto& s2_first = shell2bf[s2];
+      const auto& s2_size = obs[s2].size();
+
+      Ash(s1, s2) = A.block(s1_first, s2_first, s1_size, s2_size)
+                        .lpNorm<Eigen::Infinity>();
+    }
+  }
+
+  return Ash;
+}
+
+std::tuple<shellpair_list_t,shellpair_data_t>
+compute_shellpairs(const BasisSet& bs1,
+                   const BasisSet& _bs2,
+                   const double threshold) {
+  const BasisSet& bs2 = (_bs2.empty() ? bs1 : _bs2);
+  const auto nsh1 = bs1.size();
+  const auto nsh2 = bs2.size();
+  const auto bs1_equiv_bs2 = (&bs1 == &bs2);
+
+  using libint2::nthreads;
+
+  std::cout << "computing non-negligible shell-pair list ... ";
+
+  libint2::Timers<1> timer;
+  timer.set_now_overhead(25);
+  timer.start(0);
+
+  shellpair_list_t splist;
+
+  std::mutex mx;
+
+  auto compute = [&](int thread_id) {
+
+    // get the overlap integrals engine of this thread
+    auto& engine = engine_pool().get(
+        thread_id, Operator::overlap, std::max(bs1.max_nprim(), bs2.max_nprim()),
+        std::max(bs1.max_l(), bs2.max_l()), 0);
+    const auto& buf = engine.results();
+
+    // loop over permutationally-unique set of shells
+    for (auto s1 = 0l, s12 = 0l; s1 != nsh1; ++s1) {
+      mx.lock();
+      if (splist.find(s1) == splist.end())
+        splist.insert(std::make_pair(s1, std::vector<size_t>()));
+      mx.unlock();
+
+      auto n1 = bs1[s1].size();  // number of basis functions in this shell
+
+      auto s2_max = bs1_equiv_bs2 ? s1 : nsh2 - 1;
+      for (auto s2 = 0; s2 <= s2_max; ++s2, ++s12) {
+        if (s12 % nthreads != thread_id) continue;
+
+        auto on_same_center = (bs1[s1].O == bs2[s2].O);
+        bool significant = on_same_center;
+        if (not on_same_center) {
+          auto n2 = bs2[s2].size();
+          engine.compute(bs1[s1], bs2[s2]);
+          Eigen::Map<const Matrix> buf_mat(buf[0], n1, n2);
+          auto norm = buf_mat.norm();
+          significant = (norm >= threshold);
+        }
+
+        if (significant) {
+          mx.lock();
+          splist[s1].emplace_back(s2);
+          mx.unlock();
+        }
+      }
+    }
+  };  // end of compute
+
+  libint2::parallel_do(compute);
+
+  // resort shell list in increasing order, i.e. splist[s][s1] < splist[s][s2] if s1 < s2
+  // N.B. only parallelized over 1 shell index
+  auto sort = [&](int thread_id) {
+    for (auto s1 = 0l; s1 != nsh1; ++s1) {
+      if (s1 % nthreads == thread_id) {
+        auto& list = splist[s1];
+        std::sort(list.begin(), list.end());
+      }
+    }
+  };  // end of sort
+
+  libint2::parallel_do(sort);
+
+  // compute shellpair data assuming that we are computing to default_epsilon
+  // N.B. only parallelized over 1 shell index
+  const auto ln_max_engine_precision = std::log(max_engine_precision);
+  shellpair_data_t spdata(splist.size());
+  auto make_spdata = [&](int thread_id) {
+    for (auto s1 = 0l; s1 != nsh1; ++s1) {
+      if (s1 % nthreads == thread_id) {
+        for(const auto& s2 : splist[s1]) {
+          spdata[s1].emplace_back(std::make_shared<libint2::ShellPair>(bs1[s1],bs2[s2],ln_max_engine_precision));
+        }
+      }
+    }
+  };  // end of make_spdata
+
+  libint2::parallel_do(make_spdata);
+
+  timer.stop(0);
+  std::cout << "done (" << timer.read(0) << " s)" << std::endl;
+
+  return std::make_tuple(splist,spdata);
+}
+
+Matrix compute_2body_2index_ints(const BasisSet& bs) {
+  using libint2::nthreads;
+  const auto n = bs.nbf();
+  const auto nshells = bs.size();
+  Matrix result = Matrix::Zero(n, n);
+
+  // build engines for each thread
+  using libint2::Engine;
+  std::vector<Engine> engines(nthreads);
+  engines[0] =
+      Engine(libint2::Operator::coulomb, bs.max_nprim(), bs.max_l(), 0);
+  engines[0].set_braket(BraKet::xs_xs);
+  for (size_t i = 1; i != nthreads; ++i) {
+    engines[i] = engines[0];
+  }
+
+  auto shell2bf = bs.shell2bf();
+  auto unitshell = Shell::unit();
+
+  auto compute = [&](int thread_id) {
+
+    auto& engine = engines[thread_id];
+    const auto& buf = engine.results();
+
+    // loop over unique shell pairs, {s1,s2} such that s1 >= s2
+    // this is due to the permutational symmetry of the real integrals over
+    // Hermitian operators: (1|2) = (2|1)
+    for (auto s1 = 0l, s12 = 0l; s1 != nshells; ++s1) {
+      auto bf1 = shell2bf[s1];  // first basis function in this shell
+      auto n1 = bs[s1].size();
+
+      for (auto s2 = 0; s2 <= s1; ++s2, ++s12) {
+        if (s12 % nthreads != thread_id) continue;
+
+        auto bf2 = shell2bf[s2];
+        auto n2 = bs[s2].size();
+
+        // compute shell pair; return is the pointer to the buffer
+        engine.compute(bs[s1], bs[s2]);
+        if (buf[0] == nullptr)
+          continue; // if all integrals screened out, skip to next shell set
+
+        // "map" buffer to a const Eigen Matrix, and copy it to the
+        // corresponding blocks of the result
+        Eigen::Map<const Matrix> buf_mat(buf[0], n1, n2);
+        result.block(bf1, bf2, n1, n2) = buf_mat;
+        if (s1 != s2)  // if s1 >= s2, copy {s1,s2} to the corresponding {s2,s1}
+                       // block, note the transpose!
+          result.block(bf2, bf1, n2, n1) = buf_mat.transpose();
+      }
+    }
+  };  // compute lambda
+
+  libint2::parallel_do(compute);
+
+  return result;
+}
+
+Matrix compute_2body_fock(const BasisSet& obs, const Matrix& D,
+                          double precision, const Matrix& Schwarz,
+                          const libint2::symmetry::PetiteList* petite_list) {
+  const auto n = obs.nbf();
+  const auto nshells = obs.size();
+  using libint2::nthreads;
+  std::vector<Matrix> G(nthreads, Matrix::Zero(n, n));
+
+  const auto do_schwarz_screen = Schwarz.cols() != 0 && Schwarz.rows() != 0;
+  Matrix D_shblk_norm =
+      compute_shellblock_norm(obs, D);  // matrix of infty-norms of shell blocks
+
+  auto fock_precision = precision;
+  // engine precision controls primitive truncation, assume worst-case scenario
+  // (all primitive combinations add up constructively)
+  auto max_nprim = obs.max_nprim();
+  auto max_nprim4 = max_nprim * max_nprim * max_nprim * max_nprim;
+  auto engine_precision = std::min(fock_precision / D_shblk_norm.maxCoeff(),
+                                   std::numeric_limits<double>::epsilon()) /
+                          max_nprim4;
+  assert(engine_precision > max_engine_precision &&
+      "using precomputed shell pair data limits the max engine precision"
+  " ... make max_engine_precision smalle and recompile");
+
+  // the 2-electron repulsion integrals engines come from the pool
+  // N.B. shellset-dependent precision control will likely break positive
+  // definiteness, stick with this simple recipe
+  std::cout << "compute_2body_fock:precision = " << precision << std::endl;
+  std::cout << "Engine::precision = " << engine_precision << std::endl;
+  std::atomic<size_t> num_ints_computed{0};
+
+#if defined(REPORT_INTEGRAL_TIMINGS)
+  std::vector<libint2::Timers<1>> timers(nthreads);
+#endif
+
+  auto shell2bf = obs.shell2bf();
+
+  auto lambda = [&](int thread_id) {
+
+    auto& engine = engine_pool().get(thread_id, Operator::coulomb,
+                                     obs.max_nprim(), obs.max_l(), 0,
+                                     engine_precision);
+    auto& g = G[thread_id];
+    const auto& buf = engine.results();
+
+#if defined(REPORT_INTEGRAL_TIMINGS)
+    auto& timer = timers[thread_id];
+    timer.clear();
+    timer.set_now_overhead(25);
+#endif
+
+    // loop over permutationally-unique set of shells
+    for (auto s1 = 0l, s1234 = 0l; s1 != nshells; ++s1) {
+      auto bf1_first = shell2bf[s1];  // first basis function in this shell
+      auto n1 = obs[s1].size();       // number of basis functions in this shell
+
+      auto sp12_iter = obs_shellpair_data.at(s1).begin();
+
+      for (const auto& s2 : obs_shellpair_list[s1]) {
+        auto bf2_first = shell2bf[s2];
+        auto n2 = obs[s2].size();
+
+        const auto* sp12 = sp12_iter->get();
+        ++sp12_iter;
+
+        // the bra of a symmetry-unique quartet is a symmetry-unique pair
+        if (petite_list && petite_list->pair_weight(s1, s2) == 0) continue;
+
+        const auto Dnorm12 = do_schwarz_screen ? D_shblk_norm(s1, s2) : 0.;
+
+        for (auto s3 = 0; s3 <= s1; ++s3) {
+          auto bf3_first = shell2bf[s3];
+          auto n3 = obs[s3].size();
+
+          const auto Dnorm123 =
+              do_schwarz_screen
+                  ? std::max(D_shblk_norm(s1, s3),
+                             std::max(D_shblk_norm(s2, s3), Dnorm12))
+                  : 0.;
+
+          auto sp34_iter = obs_shellpair_data.at(s3).begin();
+
+          const auto s4_max = (s1 == s3) ? s2 : s3;
+          for (const auto& s4 : obs_shellpair_list[s3]) {
+            if (s4 > s4_max)
+              break;  // for each s3, s4 are stored in monotonically increasing
+                      // order
+
+            // must update the iter even if going to skip s4
+            const auto* sp34 = sp34_iter->get();
+            ++sp34_iter;
+
+            if ((s1234++) % nthreads != thread_id) continue;
+
+            // # of symmetry-equivalent shell sets, 0 if not unique
+            const auto s1234_sym =
+                petite_list ? petite_list->quartet_weight(s1, s2, s3, s4) : 1;
+            if (s1234_sym == 0) continue;
+
+            const auto Dnorm1234 =
+                do_schwarz_screen
+                    ? std::max(
+                          D_shblk_norm(s1, s4),
+                          std::max(D_shblk_norm(s2, s4),
+                                   std::max(D_shblk_norm(s3, s4), Dnorm123)))
+                    : 0.;
+
+            if (do_schwarz_screen &&
+                Dnorm1234 * Schwarz(s1, s2) * Schwarz(s3, s4) <
+                    fock_precision)
+              continue;
+
+            auto bf4_first = shell2bf[s4];
+            auto n4 = obs[s4].size();
+
+            num_ints_computed += n1 * n2 * n3 * n4;
+
+            // compute the permutational degeneracy (i.e. # of equivalents) of
+            // the given shell set
+            auto s12_deg = (s1 == s2) ? 1.0 : 2.0;
+            auto s34_deg = (s3 == s4) ? 1.0 : 2.0;
+            auto s12_34_deg = (s1 == s3) ? (s2 == s4 ? 1.0 : 2.0) : 2.0;
+            auto s1234_deg = s12_deg * s34_deg * s12_34_deg * s1234_sym;
+
+#if defined(REPORT_INTEGRAL_TIMINGS)
+            timer.start(0);
+#endif
+
+            engine.compute2<Operator::coulomb, BraKet::xx_xx, 0>(
+                obs[s1], obs[s2], obs[s3], obs[s4], sp12, sp34);
+            const auto* buf_1234 = buf[0];
+            if (buf_1234 == nullptr)
+              continue; // if all integrals screened out, skip to next quartet
+
+#if defined(REPORT_INTEGRAL_TIMINGS)
+            timer.stop(0);
+#endif
+
+            // 1) each shell set of integrals contributes up to 6 shell sets of
+            // the Fock matrix:
+            //    F(a,b) += (ab|cd) * D(c,d)
+            //    F(c,d) += (ab|cd) * D(a,b)
+            //    F(b,d) -= 1/4 * (ab|cd) * D(a,c)
+            //    F(b,c) -= 1/4 * (ab|cd) * D(a,d)
+            //    F(a,c) -= 1/4 * (ab|cd) * D(b,d)
+            //    F(a,d) -= 1/4 * (ab|cd) * D(b,c)
+            // 2) each permutationally-unique integral (shell set) must be
+            // scaled by its degeneracy,
+            //    i.e. the number of the integrals/sets equivalent to it
+            // 3) the end result must be symmetrized
+            for (auto f1 = 0, f1234 = 0; f1 != n1; ++f1) {
+              const auto bf1 = f1 + bf1_first;
+              for (auto f2 = 0; f2 != n2; ++f2) {
+                const auto bf2 = f2 + bf2_first;
+                for (auto f3 = 0; f3 != n3; ++f3) {
+                  const auto bf3 = f3 + bf3_first;
+                  for (auto f4 = 0; f4 != n4; ++f4, ++f1234) {
+                    const auto bf4 = f4 + bf4_first;
+
+                    const auto value = buf_1234[f1234];
+
+                    const auto value_scal_by_deg = value * s1234_deg;
+
+                    g(bf1, bf2) += D(bf3, bf4) * value_scal_by_deg;
+                    g(bf3, bf4) += D(bf1, bf2) * value_scal_by_deg;
+                    g(bf1, bf3) -= 0.25 * D(bf2, bf4) * value_scal_by_deg;
+                    g(bf2, bf4) -= 0.25 * D(bf1, bf3) * value_scal_by_deg;
+                    g(bf1, bf4) -= 0.25 * D(bf2, bf3) * value_scal_by_deg;
+                    g(bf2, bf3) -= 0.25 * D(bf1, bf4) * value_scal_by_deg;
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+
+  };  // end of lambda
+
+  libint2::Timers<2> phase_timers;
+  phase_timers.set_now_overhead(25);
+  phase_timers.start(0);
+
+  libint2::parallel_do(lambda);
+
+  phase_timers.stop(0);
+  phase_timers.start(1);
+
+  // accumulate contributions from all threads
+  for (size_t i = 1; i != nthreads; ++i) {
+    G[0] += G[i];
+  }
+
+  phase_timers.stop(1);
+  if (report_phase) {
+    report_phase("fock", phase_timers.read(0));
+    report_phase("reduction", phase_timers.read(1));
+  }
+
+#if defined(REPORT_INTEGRAL_TIMINGS)
+  double time_for_ints = 0.0;
+  for (auto& t : timers) {
+    time_for_ints += t.read(0);
+  }
+  std::cout << "time for integrals = " << time_for_ints << std::endl;
+  for (int t = 0; t != nthreads; ++t)
+    engine_pool()
+        .get(t, Operator::coulomb, obs.max_nprim(), obs.max_l(), 0,
+             engine_precision)
+        .print_timers();
+#endif
+
+  Matrix GG = 0.5 * (G[0] + G[0].transpose());
+
+  std::cout << "# of integrals = " << num_ints_computed << std::endl;
+
+  // symmetrize the result and return
+  if (petite_list) return petite_list->symmetrize(GG);
+  return GG;
+}
+
+#if LIBINT2_DERIV_ERI_ORDER
+Matrix compute_2body_gradient(const BasisSet& obs,
+                              const std::vector<Atom>& atoms, const Matrix& D,
+                              double precision, const Matrix& Schwarz) {
+  const auto nshells = obs.size();
+  const auto natoms = atoms.size();
+  using libint2::nthreads;
+  std::vector<Matrix> grad(nthreads, Matrix::Zero(natoms, 3));
+
+  const auto do_schwarz_screen = Schwarz.cols() != 0 && Schwarz.rows() != 0;
+  Matrix D_shblk_norm =
+      compute_shellblock_norm(obs, D);  // matrix of infty-norms of shell blocks
+
+  // engine precision controls primitive truncation, assume worst-case scenario
+  // (all primitive combinations add up constructively); the integrals are
+  // contracted with products of 2 densities
+  auto max_nprim = obs.max_nprim();
+  auto max_nprim4 = max_nprim * max_nprim * max_nprim * max_nprim;
+  const auto D_max = D_shblk_norm.maxCoeff();
+  auto engine_precision = std::min(precision / (D_max * D_max),
+                                   std::numeric_limits<double>::epsilon()) /
+                          max_nprim4;
+
+  std::atomic<size_t> num_ints_computed{0};
+
+  auto shell2bf = obs.shell2bf();
+  auto shell2atom = obs.shell2atom(atoms);
+
+  auto lambda = [&](int thread_id) {
+
+    auto& engine = engine_pool().get(thread_id, Operator::coulomb,
+                                     obs.max_nprim(), obs.max_l(), 1,
+                                     engine_precision);
+    // the derivatives w.r.t. the 4th center follow from translational
+    // invariance, no need to transform them
+    engine.set_unique_derivatives(true);
+    auto& g = grad[thread_id];
+    const auto& buf = engine.results();
+    std::vector<double> DD;  // density-density product for a shell quartet
+
+    size_t shell_atoms[4];
+
+    // loop over permutationally-unique set of shells
+    for (auto s1 = 0l, s1234 = 0l; s1 != nshells; ++s1) {
+      auto bf1_first = shell2bf[s1];
+      auto n1 = obs[s1].size();
+      shell_atoms[0] = shell2atom[s1];
+
+      for (const auto& s2 : obs_shellpair_list[s1]) {
+        auto bf2_first = shell2bf[s2];
+        auto n2 = obs[s2].size();
+        shell_atoms[1] = shell2atom[s2];
+
+        for (auto s3 = 0; s3 <= s1; ++s3) {
+          auto bf3_first = shell2bf[s3];
+          auto n3 = obs[s3].size();
+          shell_atoms[2] = shell2atom[s3];
+
+          const auto s4_max = (s1 == s3) ? s2 : s3;
+          for (const auto& s4 : obs_shellpair_list[s3]) {
+            if (s4 > s4_max)
+              break;  // for each s3, s4 are stored in monotonically increasing
+                      // order
+
+            if ((s1234++) % nthreads != thread_id) continue;
+
+            // screen with the bound on the density-density product (Coulomb
+            // and exchange terms) rather than on the densities
+            if (do_schwarz_screen) {
+              const auto DDnorm1234 = std::max(
+                  2 * D_shblk_norm(s1, s2) * D_shblk_norm(s3, s4),
+                  0.5 * (D_shblk_norm(s1, s3) * D_shblk_norm(s2, s4) +
+                         D_shblk_norm(s1, s4) * D_shblk_norm(s2, s3)));
+              if (DDnorm1234 * Schwarz(s1, s2) * Schwarz(s3, s4) < precision)
+                continue;
+            }
+
+            auto bf4_first = shell2bf[s4];
+            auto n4 = obs[s4].size();
+            shell_atoms[3] = shell2atom[s4];
+
+            const auto n1234 = n1 * n2 * n3 * n4;
+
+            // compute the permutational degeneracy (i.e. # of equivalents) of
+            // the given shell set
+            auto s12_deg = (s1 == s2) ? 1.0 : 2.0;
+            auto s34_deg = (s3 == s4) ? 1.0 : 2.0;
+            auto s12_34_deg = (s1 == s3) ? (s2 == s4 ? 1.0 : 2.0) : 2.0;
+            auto s1234_deg = s12_deg * s34_deg * s12_34_deg;
+
+            engine.compute2<Operator::coulomb, BraKet::xx_xx, 1>(
+                obs[s1], obs[s2], obs[s3], obs[s4]);
+            if (buf[0] == nullptr)
+              continue; // if all integrals screened out, skip to next quartet
+            num_ints_computed += 9 * n1234;
+
+            // E(2-body) = 1/2 \sum (2 D(1,2) D(3,4) - D(1,3) D(2,4)) (12|34),
+            // hence dE/dx = \sum DD(1,2,3,4) d(12|34)/dx
+            DD.resize(n1234);
+            for (auto f1 = 0, f1234 = 0; f1 != n1; ++f1) {
+              const auto bf1 = f1 + bf1_first;
+              for (auto f2 = 0; f2 != n2; ++f2) {
+                const auto bf2 = f2 + bf2_first;
+                for (auto f3 = 0; f3 != n3; ++f3) {
+                  const auto bf3 = f3 + bf3_first;
+                  for (auto f4 = 0; f4 != n4; ++f4, ++f1234) {
+                    const auto bf4 = f4 + bf4_first;
+                    DD[f1234] =
+                        s1234_deg * (2 * D(bf1, bf2) * D(bf3, bf4) -
+                                     0.5 * (D(bf1, bf3) * D(bf2, bf4) +
+                                            D(bf1, bf4) * D(bf2, bf3)));
+                  }
+                }
+              }
+            }
+
+            // contributions of the 4th center: d/dD = - (d/dA + d/dB + d/dC)
+            Eigen::Map<const Eigen::VectorXd> DD_vec(DD.data(), n1234);
+            for (auto d = 0; d != 9; ++d) {
+              const int c = d / 3;
+              const int xyz = d % 3;
+              const auto value =
+                  Eigen::Map<const Eigen::VectorXd>(buf[d], n1234).dot(DD_vec);
+              g(shell_atoms[c], xyz) += value;
+              g(shell_atoms[3], xyz) -= value;
+            }
+          }
+        }
+      }
+    }
+
+  };  // end of lambda
+
+  libint2::Timers<2> phase_timers;
+  phase_timers.set_now_overhead(25);
+  phase_timers.start(0);
+
+  libint2::parallel_do(lambda);
+
+  phase_timers.stop(0);
+  phase_timers.start(1);
+
+  // accumulate contributions from all threads
+  for (size_t t = 1; t != nthreads; ++t) grad[0] += grad[t];
+
+  phase_timers.stop(1);
+  if (report_phase) {
+    report_phase("fock_deriv", phase_timers.read(0));
+    report_phase("reduction", phase_timers.read(1));
+  }
+
+  std::cout << "compute_2body_gradient: # of integrals = " << num_ints_computed
+            << std::endl;
+
+  return grad[0];
+}
+#endif  // LIBINT2_DERIV_ERI_ORDER
+
+#ifdef HAVE_DENSITY_FITTING
+
+Matrix DFFockEngine::compute_2body_fock_dfC(const Matrix& Cocc) {
+
+  using libint2::nthreads;
+
+  const auto n = obs.nbf();
+  const auto ndf = dfbs.nbf();
+
+  libint2::Timers<1> wall_timer;
+  wall_timer.set_now_overhead(25);
+  std::vector<libint2::Timers<5>> timers(nthreads);
+  for(auto& timer: timers) timer.set_now_overhead(25);
+
+  typedef btas::RangeNd<CblasRowMajor, std::array<long, 1>> Range1d;
+  typedef btas::RangeNd<CblasRowMajor, std::array<long, 2>> Range2d;
+  typedef btas::Tensor<double, Range1d> Tensor1d;
+  typedef btas::Tensor<double, Range2d> Tensor2d;
+
+  // using first time? compute 3-center ints and transform to inv sqrt
+  // representation
+  if (xyK.size() == 0) {
+
+    wall_timer.start(0);
+
+    const auto nshells = obs.size();
+    const auto nshells_df = dfbs.size();
+
+    // construct the 2-electron 3-center repulsion integrals engine
+    // since the code assumes (xx|xs) braket, and Engine/libint only produces
+    // (xs|xx), use 4-center engine
+    std::vector<libint2::Engine> engines(nthreads);
+    engines[0] = libint2::Engine(libint2::Operator::coulomb,
+                                 std::max(obs.max_nprim(), dfbs.max_nprim()),
+                                 std::max(obs.max_l(), dfbs.max_l()), 0);
+    engines[0].set_braket(BraKet::xs_xx);
+    for (size_t i = 1; i != nthreads; ++i) {
+      engines[i] = engines[0];
+    }
+
+    auto shell2bf = obs.shell2bf();
+    auto shell2bf_df = dfbs.shell2bf();
+
+    Tensor3d Zxy{ndf, n, n};
+
+    auto lambda = [&](int thread_id) {
+
+      auto& engine = engines[thread_id];
+      auto& timer = timers[thread_id];
+      // strides of Zxy
+      const std::array<size_t, 4> strides{{size_t(n * n), size_t(n), 1, 0}};
+
+      // loop over permutationally-unique set of shells
+      for (auto s1 = 0l, s123 = 0l; s1 != nshells_df; ++s1) {
+        auto bf1_first = shell2bf_df[s1];  // first basis function in this shell
+
+        for (auto s2 = 0; s2 != nshells; ++s2) {
+          auto bf2_first = shell2bf[s2];
+
+          for (auto s3 = 0; s3 != nshells; ++s3, ++s123) {
+            if (s123 % nthreads != thread_id) continue;
+
+            auto bf3_first = shell2bf[s3];
+
+            timer.start(0);
+
+            // the integrals are copied to the
+            // {bf1_first,bf2_first,bf3_first} block of Zxy
+            auto* Zxy_blk =
+                Zxy.data() + (bf1_first * n + bf2_first) * n + bf3_first;
+            engine.compute_and_copy(&Zxy_blk, strides, 1.0, false,
+                                    dfbs[s1], obs[s2], obs[s3]);
+
+            timer.stop(0);
+          }  // s3
+        }    // s2
+      }      // s1
+
+    };  // lambda
+
+    libint2::parallel_do(lambda);
+
+    wall_timer.stop(0);
+
+    double ints_time = 0;
+    for(const auto& timer: timers) ints_time += timer.read(0);
+    std::cout << "time for Zxy integrals = " << ints_time << " (total from all threads)" << std::endl;
+    std::cout << "wall time for Zxy integrals = " << wall_timer.read(0) << std::endl;
+
+    timers[0].start(2);
+
+    Matrix V = compute_2body_2index_ints(dfbs);
+    Eigen::LLT<Matrix> V_LLt(V);
+    Matrix I = Matrix::Identity(ndf, ndf);
+    auto L = V_LLt.matrixL();
+    Matrix V_L = L;
+    Matrix Linv_t = L.solve(I).transpose();
+    // check
+    //  std::cout << "||V - L L^t|| = " << (V - V_L * V_L.transpose()).norm() <<
+    //  std::endl;
+    //  std::cout << "||I - L L^-1|| = " << (I - V_L *
+    //  Linv_t.transpose()).norm() << std::endl;
+    //  std::cout << "||V^-1 - L^-1^t L^-1|| = " << (V.inverse() - Linv_t *
+    //  Linv_t.transpose()).norm() << std::endl;
+
+    Tensor2d K{ndf, ndf};
+    std::copy(Linv_t.data(), Linv_t.data() + ndf * ndf, K.begin());
+
+    xyK = Tensor3d{n, n, ndf};
+    btas::contract(1.0, Zxy, {1, 2, 3}, K, {1, 4}, 0.0, xyK, {2, 3, 4});
+    Zxy = Tensor3d{0, 0, 0};  // release memory
+
+    timers[0].stop(2);
+    std::cout << "time for integrals metric tform = " << timers[0].read(2)
+              << std::endl;
+    if (report_phase) {
+      report_phase("df_3index", wall_timer.read(0));
+      report_phase("df_metric", timers[0].read(2));
+    }
+  }  // if (xyK.size() == 0)
+
+  // compute exchange
+  timers[0].start(3);
+
+  const auto nocc = Cocc.cols();
+  Tensor2d Co{n, nocc};
+  std::copy(Cocc.data(), Cocc.data() + n * nocc, Co.begin());
+  Tensor3d xiK{n, nocc, ndf};
+  btas::contract(1.0, xyK, {1, 2, 3}, Co, {2, 4}, 0.0, xiK, {1, 4, 3});
+
+  Tensor2d G{n, n};
+  btas::contract(1.0, xiK, {1, 2, 3}, xiK, {4, 2, 3}, 0.0, G, {1, 4});
+
+  timers[0].stop(3);
+  std::cout << "time for exchange = " << timers[0].read(3) << std::endl;
+
+  // compute Coulomb
+  timers[0].start(4);
+
+  Tensor1d Jtmp{ndf};
+  btas::contract(1.0, xiK, {1, 2, 3}, Co, {1, 2}, 0.0, Jtmp, {3});
+  xiK = Tensor3d{0, 0, 0};
+  btas::contract(2.0, xyK, {1, 2, 3}, Jtmp, {3}, -1.0, G, {1, 2});
+
+  timers[0].stop(4);
+  std::cout << "time for coulomb = " << timers[0].read(4) << std::endl;
+  if (report_phase) report_phase("fock", timers[0].read(3) + timers[0].read(4));
+
+  // copy result to an Eigen::Matrix
+  Matrix result(n, n);
+  std::copy(G.cbegin(), G.cend(), result.data());
+  return result;
+}
+#endif  // HAVE_DENSITY_FITTING
@@ -0,0 +1,45 @@
+from __future__ import print_function
+import sys, re, math
+
+def pat_numbers(n):
+    result = ''
+    for i in range(n):
+        result += '\s*([+-e\d.]+)'
+    return result
+
+def validate(label, data, refdata, tolerance, textline):
+    ok = True
+    ndata = len(refdata)
+    for i in range(ndata):
+        datum = float(data[i])
+        refdatum = refdata[i]
+        if (math.fabs(refdatum - datum) > tolerance):
+            ok = False
+            print(label, "check: failed\nreference:", refdata, "\nactual:", textline)
+            break
+    if (ok): print(label, "check: passed")
+    return ok
+
+# h2o.xyz in STO-3G basis
+eref = [-74.942080057698]
+etol = 1e-10
+
+# the error of the seminumerical exchange matrix (infinity norm) on the default
+# grid (50 radial and 12 x 24 angular points per atom) must not exceed this
+cosxtol = 2e-5
+
+eok = False
+cosxok = False
+
+for line in sys.stdin:
+    match1 = re.match('\*\* Hartree-Fock energy =' + pat_numbers(1), line)
+    match2 = re.match('\*\* COSX K error =' + pat_numbers(1), line)
+    if match1:
+        eok = validate("HF energy", match1.groups(), eref, etol, line)
+    elif match2:
+        cosxok = validate("COSX exchange matrix", match2.groups(), [0.0], cosxtol, line)
+    else:
+        print(line,end="")
+
+ok = eok and cosxok
+if not ok: sys.exit(1)
@@ -0,0 +1,46 @@
+from __future__ import print_function
+import sys, re, math
+
+def pat_numbers(n):
+    result = ''
+    for i in range(n):
+        result += '\s*([+-e\d.]+)'
+    return result
+
+def validate(label, data, refdata, tolerance, textline):
+    ok = True
+    ndata = len(refdata)
+    for i in range(ndata):
+        datum = float(data[i])
+        refdatum = refdata[i]
+        if (math.fabs(refdatum - datum) > tolerance):
+            ok = False
+            print(label, "check: failed\nreference:", refdata, "\nactual:", textline)
+            break
+    if (ok): print(label, "check: passed")
+    return ok
+
+# h2o_rotated.xyz in STO-3G basis
+eref = [-74.942080057699]
+etol = 5e-12
+
+# the Fock matrices extrapolated by DIIS with the history stored in single
+# precision must agree with those of double precision DIIS to this tolerance
+# (infinity norm), about the float epsilon times the magnitude of F
+diistol = 1e-6
+
+eok = False
+diisok = False
+
+for line in sys.stdin:
+    match1 = re.match('\*\* Hartree-Fock energy =' + pat_numbers(1), line)
+    match2 = re.match('\*\* DIIS float storage error =' + pat_numbers(1), line)
+    if match1:
+        eok = validate("HF energy", match1.groups(), eref, etol, line)
+    elif match2:
+        diisok = validate("DIIS with float storage", match2.groups(), [0.0], diistol, line)
+    else:
+        print(line,end="")
+
+ok = eok and diisok
+if not ok: sys.exit(1)
@@ -0,0 +1,51 @@
+from __future__ import print_function
+import sys, re, math
+
+def pat_numbers(n):
+    result = ''
+    for i in range(n):
+        result += '\s*([+-e\d.]+)'
+    return result
+
+def validate(label, data, refdata, tolerance, textline):
+    ok = True
+    ndata = len(refdata)
+    for i in range(ndata):
+        datum = float(data[i])
+        refdatum = refdata[i]
+        if (math.fabs(refdatum - datum) > tolerance):
+            ok = False
+            print(label, "check: failed\nreference:", refdata, "\nactual:", textline)
+            break
+    if (ok): print(label, "check: passed")
+    return ok
+
+# h2o_chain.xyz in STO-3G basis
+eref = [-599.534062335866]
+etol = 1e-10
+
+# the error of the FMM Coulomb matrix (infinity norm) must not exceed this
+fmmtol = 1e-5
+
+eok = False
+farok = False
+fmmok = False
+
+for line in sys.stdin:
+    match1 = re.match('\*\* Hartree-Fock energy =' + pat_numbers(1), line)
+    match2 = re.match('\*\* FMM J error =' + pat_numbers(1), line)
+    # the first FMM build is the approximate one
+    match3 = re.match('compute_2body_J_fmm: .* # of near/far box pairs = (\d+)/(\d+)', line)
+    if match1:
+        eok = validate("HF energy", match1.groups(), eref, etol, line)
+    elif match2:
+        fmmok = validate("FMM Coulomb matrix", match2.groups(), [0.0], fmmtol, line)
+    elif match3 and not farok:
+        farok = int(match3.group(2)) > 0
+        print("FMM far interactions check:", "passed" if farok else "failed")
+        print(line,end="")
+    else:
+        print(line,end="")
+
+ok = eok and farok and fmmok
+if not ok: sys.exit(1)
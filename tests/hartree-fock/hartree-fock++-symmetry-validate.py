@@ -0,0 +1,48 @@
+from __future__ import print_function
+import sys, re, math
+
+def pat_numbers(n):
+    result = ''
+    for i in range(n):
+        result += '\s*([+-e\d.]+)'
+    return result
+
+def validate(label, data, refdata, tolerance, textline):
+    ok = True
+    ndata = len(refdata)
+    for i in range(ndata):
+        datum = float(data[i])
+        refdatum = refdata[i]
+        if (math.fabs(refdatum - datum) > tolerance):
+            ok = False
+            print(label, "check: failed\nreference:", refdata, "\nactual:", textline)
+            break
+    if (ok): print(label, "check: passed")
+    return ok
+
+# point groups and reference energies, the latter computed without symmetry
+# (in a rotated frame)
+refs = {
+  'h2o':  ('c2v', -75.974748265221),  # h2o.xyz, 6-31G*
+  'c2h4': ('d2h', -78.039716693355),  # c2h4.xyz, cc-pVDZ
+}
+pgref, eref = refs[sys.argv[1]]
+etol = 5e-11
+
+pgok = False
+eok = False
+
+for line in sys.stdin:
+    match1 = re.match('\*\* Hartree-Fock energy =' + pat_numbers(1), line)
+    match2 = re.match('point group = (\w+)', line)
+    if match1:
+        eok = validate("HF energy", match1.groups(), [eref], etol, line)
+    elif match2:
+        pgok = match2.group(1) == pgref
+        if (pgok): print("point group check: passed")
+        else: print("point group check: failed\nreference:", pgref, "\nactual:", line, end="")
+    else:
+        print(line,end="")
+
+ok = pgok and eok
+if not ok: sys.exit(1)
@@ -22,12 +22,15 @@
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <complex>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
@@ -38,53 +41,28 @@
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
 
-// have BTAS library?
-#ifdef LIBINT2_HAVE_BTAS
-#include <btas/btas.h>
-#endif  // LIBINT2_HAVE_BTAS
-
 // Libint Gaussian integrals library
 #include <libint2/diis.h>
+#include <libint2/engine_pool.h>
 #include <libint2/util/intpart_iter.h>
 #include <libint2/chemistry/sto3g_atomic_density.h>
 #include <libint2/lcao/molden.h>
 #include <libint2.hpp>
+#include <libint2/symmetry.h>
 
 #if defined(_OPENMP)
 #include <omp.h>
 #endif
 
-/// to use precomputed shell pair data must decide on max precision a priori
-const auto max_engine_precision = std::numeric_limits<double>::epsilon() / 1e10;
-
 // uncomment if want to report integral timings
 // N.B. integral engine timings are controled in engine.h
 #define REPORT_INTEGRAL_TIMINGS
 
-typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-    Matrix;  // import dense, dynamically sized Matrix type from Eigen;
-             // this is a matrix with row-major storage
-             // (http://en.wikipedia.org/wiki/Row-major_order)
-// to meet the layout of the integrals returned by the Libint integral library
-typedef Eigen::DiagonalMatrix<double, Eigen::Dynamic, Eigen::Dynamic>
-    DiagonalMatrix;
-
-using libint2::Shell;
-using libint2::Atom;
-using libint2::BasisSet;
-using libint2::Operator;
-using libint2::BraKet;
+// the integral and Fock matrix builders
+#include "hartree-fock++.h"
 
 std::vector<Atom> read_geometry(const std::string& filename);
 Matrix compute_soad(const std::vector<Atom>& atoms);
-// computes norm of shell-blocks of A
-Matrix compute_shellblock_norm(const BasisSet& obs, const Matrix& A);
-
-template <Operator obtype, typename OperatorParams = typename libint2::operator_traits<obtype>::oper_params_type>
-std::array<Matrix, libint2::operator_traits<obtype>::nopers> compute_1body_ints(
-    const BasisSet& obs,
-    OperatorParams oparams =
-        OperatorParams());
 
 #if LIBINT2_DERIV_ONEBODY_ORDER
 template <Operator obtype>
@@ -93,36 +71,33 @@ std::vector<Matrix> compute_1body_ints_deriv(unsigned deriv_order,
                                              const std::vector<Atom>& atoms);
 #endif  // LIBINT2_DERIV_ONEBODY_ORDER
 
-template <libint2::Operator Kernel = libint2::Operator::coulomb>
-Matrix compute_schwarz_ints(
-    const BasisSet& bs1, const BasisSet& bs2 = BasisSet(),
-    bool use_2norm = false,  // use infty norm by default
-    typename libint2::operator_traits<Kernel>::oper_params_type params =
-        libint2::operator_traits<Kernel>::default_params());
 Matrix compute_do_ints(const BasisSet& bs1, const BasisSet& bs2 = BasisSet(),
                        bool use_2norm = false  // use infty norm by default
                        );
 
-using shellpair_list_t = std::unordered_map<size_t, std::vector<size_t>>;
-shellpair_list_t obs_shellpair_list;  // shellpair list for OBS
-using shellpair_data_t = std::vector<std::vector<std::shared_ptr<libint2::ShellPair>>>;  // in same order as shellpair_list_t
-shellpair_data_t obs_shellpair_data;  // shellpair data for OBS
-
-/// computes non-negligible shell pair list; shells \c i and \c j form a
-/// non-negligible
-/// pair if they share a center or the Frobenius norm of their overlap is
-/// greater than threshold
-std::tuple<shellpair_list_t,shellpair_data_t>
-compute_shellpairs(const BasisSet& bs1,
-                   const BasisSet& bs2 = BasisSet(),
-                   double threshold = 1e-12);
-
-Matrix compute_2body_fock(
+// computes the Coulomb matrix, J(a,b) = (ab|cd) D(c,d), using the fast multipole
+// method: charge distributions of shell pairs are sorted into an octree,
+// interactions of well-separated boxes (whose extents add up to less than
+// theta times the distance between their centers) are computed from the
+// spherical multipole moments of their densities (up to MULTIPOLE_MAX_ORDER),
+// the rest exactly from 4-center integrals. theta = 0 produces the exact J.
+Matrix compute_2body_J_fmm(
     const BasisSet& obs, const Matrix& D,
     double precision = std::numeric_limits<
         double>::epsilon(),  // discard contributions smaller than this
-    const Matrix& Schwarz = Matrix()  // K_ij = sqrt(||(ij|ij)||_\infty); if
+    const Matrix& Schwarz = Matrix(),  // K_ij = sqrt(||(ij|ij)||_\infty); if
                                        // empty, do not Schwarz screen
+    double theta = 0.5);
+// computes the exchange matrix, K(a,b) = (ac|bd) D(c,d), seminumerically
+// (chain-of-spheres exchange, F. Neese et al., Chem Phys 356, 98 (2009)):
+// the integration over the coordinates of one electron is performed on Becke's
+// molecular grid with nrad radial and ntheta x 2 ntheta angular points per atom,
+// the other analytically, as (a|1/|r-r_g||b) potential integrals
+Matrix compute_2body_K_seminumerical(
+    const BasisSet& obs, const std::vector<Atom>& atoms, const Matrix& D,
+    size_t nrad = 50, size_t ntheta = 12,
+    double precision = std::numeric_limits<
+        double>::epsilon()  // discard contributions smaller than this
     );
 // an Fock builder that can accept densities expressed a separate basis
 Matrix compute_2body_fock_general(
@@ -152,47 +127,10 @@ std::vector<Matrix> compute_2body_fock_deriv(
 std::tuple<Matrix, Matrix, double> conditioning_orthogonalizer(
     const Matrix& S, double S_condition_number_threshold);
 
-#ifdef LIBINT2_HAVE_BTAS
-#define HAVE_DENSITY_FITTING 1
-struct DFFockEngine {
-  const BasisSet& obs;
-  const BasisSet& dfbs;
-  DFFockEngine(const BasisSet& _obs, const BasisSet& _dfbs)
-      : obs(_obs), dfbs(_dfbs) {}
-
-  typedef btas::RangeNd<CblasRowMajor, std::array<long, 3>> Range3d;
-  typedef btas::Tensor<double, Range3d> Tensor3d;
-  Tensor3d xyK;
-
-  // a DF-based builder, using coefficients of occupied MOs
-  Matrix compute_2body_fock_dfC(const Matrix& Cocc);
-};
-#endif  // HAVE_DENSITY_FITTING
-
-namespace libint2 {
-int nthreads;
-
-/// fires off \c nthreads instances of lambda in parallel
-template <typename Lambda>
-void parallel_do(Lambda& lambda) {
-#ifdef _OPENMP
-#pragma omp parallel
-  {
-    auto thread_id = omp_get_thread_num();
-    lambda(thread_id);
-  }
-#else  // use C++11 threads
-  std::vector<std::thread> threads;
-  for (int thread_id = 0; thread_id != libint2::nthreads; ++thread_id) {
-    if (thread_id != nthreads - 1)
-      threads.push_back(std::thread(lambda, thread_id));
-    else
-      lambda(thread_id);
-  }  // threads_id
-  for (int thread_id = 0; thread_id < nthreads - 1; ++thread_id)
-    threads[thread_id].join();
-#endif
-}
+/// @return true if environment variable \c name is set to a nonempty value
+bool getenv_flag(const char* name) {
+  auto cstr = getenv(name);
+  return cstr && strcmp(cstr, "");
 }
 
 int main(int argc, char* argv[]) {
@@ -268,6 +206,12 @@ int main(int argc, char* argv[]) {
     BasisSet obs(basisname, atoms);
     cout << "orbital basis set rank = " << obs.nbf() << endl;
 
+    // the Fock builds of the SCF iterations only compute the integrals that
+    // are unique w.r.t. the (Abelian) point group of the molecule
+    const auto point_group = libint2::symmetry::PointGroup::detect(atoms);
+    const libint2::symmetry::PetiteList petite_list(point_group, atoms, obs);
+    cout << "point group = " << point_group.name() << endl;
+
 #ifdef HAVE_DENSITY_FITTING
     BasisSet dfbs;
     if (do_density_fitting) {
@@ -378,6 +322,12 @@ int main(int argc, char* argv[]) {
     auto ehf = 0.0;
     auto n2 = D.cols() * D.rows();
     libint2::DIIS<Matrix> diis(2);  // start DIIS on second iteration
+    // if LIBINT_CHECK_DIIS is set, DIIS with the history stored in single
+    // precision is run alongside, and its extrapolated Fock matrices are
+    // compared to those of the double precision DIIS
+    const auto check_diis_float = getenv_flag("LIBINT_CHECK_DIIS");
+    libint2::DIIS<Matrix, Eigen::MatrixXf> diis_float(2);
+    auto diis_float_error = 0.0;
 
     // prepare for incremental Fock build ...
     Matrix D_diff = D;
@@ -423,7 +373,7 @@ int main(int argc, char* argv[]) {
         const auto precision_F = std::min(
             std::min(1e-3 / XtX_condition_number, 1e-7),
             std::max(rms_error / 1e4, std::numeric_limits<double>::epsilon()));
-        F += compute_2body_fock(obs, D_diff, precision_F, K);
+        F += compute_2body_fock(obs, D_diff, precision_F, K, &petite_list);
       }
 #if HAVE_DENSITY_FITTING
       else {  // do DF
@@ -451,6 +401,13 @@ int main(int argc, char* argv[]) {
                           // build; only used to produce the density
                           // make a copy of the unextrapolated matrix
       diis.extrapolate(F_diis, FD_comm);
+      if (check_diis_float) {
+        Matrix F_diis_float = F;
+        diis_float.extrapolate(F_diis_float, FD_comm);
+        diis_float_error =
+            std::max(diis_float_error,
+                     (F_diis_float - F_diis).lpNorm<Eigen::Infinity>());
+      }
 
       // solve F C = e S C by (conditioned) transformation to F' C' = e C',
       // where
@@ -477,6 +434,9 @@ int main(int argc, char* argv[]) {
     } while (((ediff_rel > conv) || (rms_error > conv)) && (iter < maxiter));
 
     printf("** Hartree-Fock energy = %20.12f\n", ehf + enuc);
+    if (check_diis_float)
+      std::cout << "** DIIS float storage error = " << diis_float_error
+                << std::endl;
 
     // dump orbs to a molden file
     {
@@ -563,6 +523,32 @@ int main(int argc, char* argv[]) {
 #endif
     }
 
+    // compute the Coulomb matrix with FMM and compare to the exact result;
+    // only done if LIBINT_CHECK_FMM is set, since J is built twice and only
+    // systems with well-separated fragments (e.g. h2o_chain.xyz) have far
+    // interactions to test
+    if (getenv_flag("LIBINT_CHECK_FMM")) {
+      const auto precision_J = 1e-12;
+      auto J_fmm = compute_2body_J_fmm(obs, D, precision_J, K);
+      auto J = compute_2body_J_fmm(obs, D, precision_J, K, 0.0);
+      std::cout << "** FMM J error = " << (J_fmm - J).lpNorm<Eigen::Infinity>()
+                << std::endl;
+    }
+
+    // compute the exchange matrix seminumerically and compare to the exact
+    // result, obtained from the 2-body Fock matrix, G = 2 J - K; this costs
+    // more than the SCF itself, hence only done if LIBINT_CHECK_COSX is set
+    if (getenv_flag("LIBINT_CHECK_COSX")) {
+      const auto precision_K = 1e-12;
+      auto K_cosx = compute_2body_K_seminumerical(obs, atoms, D, 50, 12,
+                                                  precision_K);
+      auto J = compute_2body_J_fmm(obs, D, precision_K, K, 0.0);
+      auto G = compute_2body_fock(obs, D, precision_K, K);
+      Matrix K_exact = 2 * J - G;
+      std::cout << "** COSX K error = "
+                << (K_cosx - K_exact).lpNorm<Eigen::Infinity>() << std::endl;
+    }
+
     {  // compute force
 #if LIBINT2_DERIV_ONEBODY_ORDER
       // compute 1-e forces
@@ -612,14 +598,11 @@ int main(int argc, char* argv[]) {
       //////////
       // two-body contributions to the forces
       //////////
-      auto G1 = compute_2body_fock_deriv<1>(obs, atoms, D);
-      for (auto atom = 0, i = 0; atom != atoms.size(); ++atom) {
-        for (auto xyz = 0; xyz != 3; ++xyz, ++i) {
-          // identity prefactor since E(HF) = trace(H + F, D) = trace(2H + G, D)
-          auto force = G1[i].cwiseProduct(D).sum();
-          F2(atom, xyz) += force;
-        }
-      }
+      // the derivative integrals are contracted with the densities directly,
+      // without forming the derivatives of the Fock matrix; screen with the
+      // same Schwarz bounds as the Fock build
+      const auto precision_F2 = 1e-12;
+      F2 += compute_2body_gradient(obs, atoms, D, precision_F2, K);
 
       std::cout << "** 2-body forces = ";
       for (int atom = 0; atom != atoms.size(); ++atom)
@@ -824,6 +807,7 @@ int main(int argc, char* argv[]) {
 #endif
     }
 
+    engine_pool().clear();
     libint2::finalize();  // done with libint
 
   }  // end of try block; if any exceptions occurred, report them and exit
@@ -902,94 +886,6 @@ Matrix compute_soad(const std::vector<Atom>& atoms) {
   return D * 0.5;  // we use densities normalized to # of electrons/2
 }
 
-Matrix compute_shellblock_norm(const BasisSet& obs, const Matrix& A) {
-  const auto nsh = obs.size();
-  Matrix Ash(nsh, nsh);
-
-  auto shell2bf = obs.shell2bf();
-  for (size_t s1 = 0; s1 != nsh; ++s1) {
-    const auto& s1_first = shell2bf[s1];
-    const auto& s1_size = obs[s1].size();
-    for (size_t s2 = 0; s2 != nsh; ++s2) {
-      const auto& s2_first = shell2bf[s2];
-      const auto& s2_size = obs[s2].size();
-
-      Ash(s1, s2) = A.block(s1_first, s2_first, s1_size, s2_size)
-                        .lpNorm<Eigen::Infinity>();
-    }
-  }
-
-  return Ash;
-}
-
-template <Operator obtype, typename OperatorParams>
-std::array<Matrix, libint2::operator_traits<obtype>::nopers> compute_1body_ints(
-    const BasisSet& obs, OperatorParams oparams) {
-  const auto n = obs.nbf();
-  const auto nshells = obs.size();
-  using libint2::nthreads;
-  typedef std::array<Matrix, libint2::operator_traits<obtype>::nopers>
-      result_type;
-  const unsigned int nopers = libint2::operator_traits<obtype>::nopers;
-  result_type result;
-  for (auto& r : result) r = Matrix::Zero(n, n);
-
-  // construct the 1-body integrals engine
-  std::vector<libint2::Engine> engines(nthreads);
-  engines[0] = libint2::Engine(obtype, obs.max_nprim(), obs.max_l(), 0);
-  // pass operator params to the engine, e.g.
-  // nuclear attraction ints engine needs to know where the charges sit ...
-  // the nuclei are charges in this case; in QM/MM there will also be classical
-  // charges
-  engines[0].set_params(oparams);
-  for (size_t i = 1; i != nthreads; ++i) {
-    engines[i] = engines[0];
-  }
-
-  auto shell2bf = obs.shell2bf();
-
-  auto compute = [&](int thread_id) {
-
-    const auto& buf = engines[thread_id].results();
-
-    // loop over unique shell pairs, {s1,s2} such that s1 >= s2
-    // this is due to the permutational symmetry of the real integrals over
-    // Hermitian operators: (1|2) = (2|1)
-    for (auto s1 = 0l, s12 = 0l; s1 != nshells; ++s1) {
-      auto bf1 = shell2bf[s1];  // first basis function in this shell
-      auto n1 = obs[s1].size();
-
-      auto s1_offset = s1 * (s1+1) / 2;
-      for (auto s2: obs_shellpair_list[s1]) {
-        auto s12 = s1_offset + s2;
-        if (s12 % nthreads != thread_id) continue;
-
-        auto bf2 = shell2bf[s2];
-        auto n2 = obs[s2].size();
-
-        auto n12 = n1 * n2;
-
-        // compute shell pair; return is the pointer to the buffer
-        engines[thread_id].compute(obs[s1], obs[s2]);
-
-        for (unsigned int op = 0; op != nopers; ++op) {
-          // "map" buffer to a const Eigen Matrix, and copy it to the
-          // corresponding blocks of the result
-          Eigen::Map<const Matrix> buf_mat(buf[op], n1, n2);
-          result[op].block(bf1, bf2, n1, n2) = buf_mat;
-          if (s1 != s2)  // if s1 >= s2, copy {s1,s2} to the corresponding
-                         // {s2,s1} block, note the transpose!
-            result[op].block(bf2, bf1, n2, n1) = buf_mat.transpose();
-        }
-      }
-    }
-  };  // compute lambda
-
-  libint2::parallel_do(compute);
-
-  return result;
-}
-
 #if LIBINT2_DERIV_ONEBODY_ORDER
 template <Operator obtype>
 std::vector<Matrix> compute_1body_ints_deriv(unsigned deriv_order,
@@ -1197,187 +1093,11 @@ std::vector<Matrix> compute_1body_ints_deriv(unsigned deriv_order,
 }
 #endif
 
-template <libint2::Operator Kernel>
-Matrix compute_schwarz_ints(
-    const BasisSet& bs1, const BasisSet& _bs2, bool use_2norm,
-    typename libint2::operator_traits<Kernel>::oper_params_type params) {
-  const BasisSet& bs2 = (_bs2.empty() ? bs1 : _bs2);
-  const auto nsh1 = bs1.size();
-  const auto nsh2 = bs2.size();
-  const auto bs1_equiv_bs2 = (&bs1 == &bs2);
-
-  Matrix K = Matrix::Zero(nsh1, nsh2);
-
-  // construct the 2-electron repulsion integrals engine
-  using libint2::Engine;
-  using libint2::nthreads;
-  std::vector<Engine> engines(nthreads);
-
-  // !!! very important: cannot screen primitives in Schwarz computation !!!
-  auto epsilon = 0.;
-  engines[0] = Engine(Kernel, std::max(bs1.max_nprim(), bs2.max_nprim()),
-                      std::max(bs1.max_l(), bs2.max_l()), 0, epsilon, params);
-  for (size_t i = 1; i != nthreads; ++i) {
-    engines[i] = engines[0];
-  }
-
-  std::cout << "computing Schwarz bound prerequisites (kernel=" << (int)Kernel
-            << ") ... ";
-
-  libint2::Timers<1> timer;
-  timer.set_now_overhead(25);
-  timer.start(0);
-
-  auto compute = [&](int thread_id) {
-
-    const auto& buf = engines[thread_id].results();
-
-    // loop over permutationally-unique set of shells
-    for (auto s1 = 0l, s12 = 0l; s1 != nsh1; ++s1) {
-      auto n1 = bs1[s1].size();  // number of basis functions in this shell
-
-      auto s2_max = bs1_equiv_bs2 ? s1 : nsh2 - 1;
-      for (auto s2 = 0; s2 <= s2_max; ++s2, ++s12) {
-        if (s12 % nthreads != thread_id) continue;
-
-        auto n2 = bs2[s2].size();
-        auto n12 = n1 * n2;
-
-        engines[thread_id].compute2<Kernel, BraKet::xx_xx, 0>(bs1[s1], bs2[s2],
-                                                              bs1[s1], bs2[s2]);
-        assert(buf[0] != nullptr &&
-               "to compute Schwarz ints turn off primitive screening");
-
-        // to apply Schwarz inequality to individual integrals must use the diagonal elements
-        // to apply it to sets of functions (e.g. shells) use the whole shell-set of ints here
-        Eigen::Map<const Matrix> buf_mat(buf[0], n12, n12);
-        auto norm2 = use_2norm ? buf_mat.norm()
-                               : buf_mat.lpNorm<Eigen::Infinity>();
-        K(s1, s2) = std::sqrt(norm2);
-        if (bs1_equiv_bs2) K(s2, s1) = K(s1, s2);
-      }
-    }
-  };  // thread lambda
-
-  libint2::parallel_do(compute);
-
-  timer.stop(0);
-  std::cout << "done (" << timer.read(0) << " s)" << std::endl;
-
-  return K;
-}
-
 Matrix compute_do_ints(const BasisSet& bs1, const BasisSet& bs2,
                        bool use_2norm) {
   return compute_schwarz_ints<libint2::Operator::delta>(bs1, bs2, use_2norm);
 }
 
-std::tuple<shellpair_list_t,shellpair_data_t>
-compute_shellpairs(const BasisSet& bs1,
-                   const BasisSet& _bs2,
-                   const double threshold) {
-  const BasisSet& bs2 = (_bs2.empty() ? bs1 : _bs2);
-  const auto nsh1 = bs1.size();
-  const auto nsh2 = bs2.size();
-  const auto bs1_equiv_bs2 = (&bs1 == &bs2);
-
-  using libint2::nthreads;
-
-  // construct the 2-electron repulsion integrals engine
-  using libint2::Engine;
-  std::vector<Engine> engines;
-  engines.reserve(nthreads);
-  engines.emplace_back(Operator::overlap,
-                       std::max(bs1.max_nprim(), bs2.max_nprim()),
-                       std::max(bs1.max_l(), bs2.max_l()), 0);
-  for (size_t i = 1; i != nthreads; ++i) {
-    engines.push_back(engines[0]);
-  }
-
-  std::cout << "computing non-negligible shell-pair list ... ";
-
-  libint2::Timers<1> timer;
-  timer.set_now_overhead(25);
-  timer.start(0);
-
-  shellpair_list_t splist;
-
-  std::mutex mx;
-
-  auto compute = [&](int thread_id) {
-
-    auto& engine = engines[thread_id];
-    const auto& buf = engine.results();
-
-    // loop over permutationally-unique set of shells
-    for (auto s1 = 0l, s12 = 0l; s1 != nsh1; ++s1) {
-      mx.lock();
-      if (splist.find(s1) == splist.end())
-        splist.insert(std::make_pair(s1, std::vector<size_t>()));
-      mx.unlock();
-
-      auto n1 = bs1[s1].size();  // number of basis functions in this shell
-
-      auto s2_max = bs1_equiv_bs2 ? s1 : nsh2 - 1;
-      for (auto s2 = 0; s2 <= s2_max; ++s2, ++s12) {
-        if (s12 % nthreads != thread_id) continue;
-
-        auto on_same_center = (bs1[s1].O == bs2[s2].O);
-        bool significant = on_same_center;
-        if (not on_same_center) {
-          auto n2 = bs2[s2].size();
-          engines[thread_id].compute(bs1[s1], bs2[s2]);
-          Eigen::Map<const Matrix> buf_mat(buf[0], n1, n2);
-          auto norm = buf_mat.norm();
-          significant = (norm >= threshold);
-        }
-
-        if (significant) {
-          mx.lock();
-          splist[s1].emplace_back(s2);
-          mx.unlock();
-        }
-      }
-    }
-  };  // end of compute
-
-  libint2::parallel_do(compute);
-
-  // resort shell list in increasing order, i.e. splist[s][s1] < splist[s][s2] if s1 < s2
-  // N.B. only parallelized over 1 shell index
-  auto sort = [&](int thread_id) {
-    for (auto s1 = 0l; s1 != nsh1; ++s1) {
-      if (s1 % nthreads == thread_id) {
-        auto& list = splist[s1];
-        std::sort(list.begin(), list.end());
-      }
-    }
-  };  // end of sort
-
-  libint2::parallel_do(sort);
-
-  // compute shellpair data assuming that we are computing to default_epsilon
-  // N.B. only parallelized over 1 shell index
-  const auto ln_max_engine_precision = std::log(max_engine_precision);
-  shellpair_data_t spdata(splist.size());
-  auto make_spdata = [&](int thread_id) {
-    for (auto s1 = 0l; s1 != nsh1; ++s1) {
-      if (s1 % nthreads == thread_id) {
-        for(const auto& s2 : splist[s1]) {
-          spdata[s1].emplace_back(std::make_shared<libint2::ShellPair>(bs1[s1],bs2[s2],ln_max_engine_precision));
-        }
-      }
-    }
-  };  // end of make_spdata
-
-  libint2::parallel_do(make_spdata);
-
-  timer.stop(0);
-  std::cout << "done (" << timer.read(0) << " s)" << std::endl;
-
-  return std::make_tuple(splist,spdata);
-}
-
 // returns {X,X^{-1},rank,A_condition_number,result_A_condition_number}, where
 // X is the generalized square-root-inverse such that X.transpose() * A * X = I
 //
@@ -1457,263 +1177,712 @@ std::tuple<Matrix, Matrix, double> conditioning_orthogonalizer(
   return std::make_tuple(X, Xinv, XtX_condition_number);
 }
 
-Matrix compute_2body_2index_ints(const BasisSet& bs) {
-  using libint2::nthreads;
-  const auto n = bs.nbf();
-  const auto nshells = bs.size();
-  Matrix result = Matrix::Zero(n, n);
+namespace fmm {
+
+typedef std::complex<double> complex;
+
+// index of the multipole moment {l,m}, -l <= m <= l, in the Libint's layout
+// of the Operator::sphemultipole shell sets
+inline int lm_index(int l, int m) { return l * l + l + m; }
+
+// converts real spherical multipole moments computed by Libint
+// (N^+_{l,m} for m >= 0, N^-_{l,|m|} for m < 0, see Pérez-Jordá and Yang,
+// J Chem Phys 104, 8003 (1996)) to the scaled complex regular solid harmonics,
+// R_{l,m} = N^+_{l,m} + i N^-_{l,m}, R_{l,-m} = (-1)^m R^*_{l,m}
+void real_to_complex(int lmax, const double* real_moments,
+                     complex* moments) {
+  for (int l = 0; l <= lmax; ++l) {
+    moments[lm_index(l, 0)] = real_moments[lm_index(l, 0)];
+    for (int m = 1; m <= l; ++m) {
+      const complex R_lm(real_moments[lm_index(l, m)],
+                         real_moments[lm_index(l, -m)]);
+      moments[lm_index(l, m)] = R_lm;
+      moments[lm_index(l, -m)] = (m % 2 ? -1.0 : 1.0) * std::conj(R_lm);
+    }
+  }
+}
 
-  // build engines for each thread
-  using libint2::Engine;
-  std::vector<Engine> engines(nthreads);
-  engines[0] =
-      Engine(libint2::Operator::coulomb, bs.max_nprim(), bs.max_l(), 0);
-  engines[0].set_braket(BraKet::xs_xs);
-  for (size_t i = 1; i != nthreads; ++i) {
-    engines[i] = engines[0];
+// the inverse of real_to_complex() for the coefficients of a linear
+// functional: computes w such that Re(sum_{lm} R^*_{lm} L_{lm}) =
+// sum_{k} w_k N_k, where N_k are the real moments
+void complex_to_real_functional(int lmax, const complex* L, double* w) {
+  for (int l = 0; l <= lmax; ++l) {
+    w[lm_index(l, 0)] = L[lm_index(l, 0)].real();
+    for (int m = 1; m <= l; ++m) {
+      const auto phase = (m % 2 ? -1.0 : 1.0);
+      const auto& L_p = L[lm_index(l, m)];
+      const auto& L_m = L[lm_index(l, -m)];
+      w[lm_index(l, m)] = L_p.real() + phase * L_m.real();
+      w[lm_index(l, -m)] = L_p.imag() - phase * L_m.imag();
+    }
   }
+}
 
-  auto shell2bf = bs.shell2bf();
-  auto unitshell = Shell::unit();
+// computes the scaled irregular solid harmonics,
+// I_{l,m}(r) = (l-m)! P_l^m(cos theta) exp(i m phi) / r^{l+1}, for l <= lmax
+void irregular_harmonics(int lmax, const std::array<double, 3>& r,
+                         std::vector<complex>& I) {
+  I.resize((lmax + 1) * (lmax + 1));
+  const auto r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+  const auto oo_r2 = 1.0 / r2;
+  // use the standard recurrences in Cartesian form, e.g. see
+  // Helgaker, Jorgensen, Olsen, "Molecular Electronic-Structure Theory"
+  // I_{m+1,m+1} = -(2m+1) (x + iy) / r^2 I_{m,m}
+  // I_{l+1,m} = ((2l+1) z I_{l,m} - l^2-m^2 I_{l-1,m}) / r^2
+  const complex x_iy(r[0], r[1]);
+  I[lm_index(0, 0)] = std::sqrt(oo_r2);
+  for (int m = 0; m < lmax; ++m)
+    I[lm_index(m + 1, m + 1)] =
+        -double(2 * m + 1) * x_iy * oo_r2 * I[lm_index(m, m)];
+  for (int m = 0; m <= lmax; ++m) {
+    for (int l = m; l < lmax; ++l) {
+      const auto I_lm1 = (l > m) ? I[lm_index(l - 1, m)] : complex(0.0);
+      I[lm_index(l + 1, m)] =
+          (double(2 * l + 1) * r[2] * I[lm_index(l, m)] -
+           double(l * l - m * m) * I_lm1) * oo_r2;
+    }
+  }
+  for (int l = 1; l <= lmax; ++l)
+    for (int m = 1; m <= l; ++m)
+      I[lm_index(l, -m)] = (m % 2 ? -1.0 : 1.0) * std::conj(I[lm_index(l, m)]);
+}
 
-  auto compute = [&](int thread_id) {
+// adds the local expansion around O_A created by multipoles M_B around O_B,
+// R_AB = O_A - O_B:
+// L_{jk} += (-1)^j \sum_{lm} M^*_{lm} I_{l+j,k+m}(R_AB)
+void m2l(int p, const complex* M_B, const std::vector<complex>& I_AB,
+         complex* L_A) {
+  for (int j = 0; j <= p; ++j) {
+    const auto phase = (j % 2 ? -1.0 : 1.0);
+    for (int k = -j; k <= j; ++k) {
+      complex L_jk(0.0);
+      for (int l = 0; l <= p; ++l) {
+        for (int m = -l; m <= l; ++m) {
+          L_jk += std::conj(M_B[lm_index(l, m)]) * I_AB[lm_index(l + j, k + m)];
+        }
+      }
+      L_A[lm_index(j, k)] += phase * L_jk;
+    }
+  }
+}
 
-    auto& engine = engines[thread_id];
-    const auto& buf = engine.results();
+// a charge distribution of a (non-negligible) shell pair
+struct Distribution {
+  size_t s1, s2;  // s1 >= s2
+  const libint2::ShellPair* sp;
+  std::array<double, 3> center;
+  double extent;  // radius of the sphere outside which the distribution is negligible
+};
 
-    // loop over unique shell pairs, {s1,s2} such that s1 >= s2
-    // this is due to the permutational symmetry of the real integrals over
-    // Hermitian operators: (1|2) = (2|1)
-    for (auto s1 = 0l, s12 = 0l; s1 != nshells; ++s1) {
-      auto bf1 = shell2bf[s1];  // first basis function in this shell
-      auto n1 = bs[s1].size();
+// a box of the octree
+struct Box {
+  std::array<double, 3> center;
+  double half_size;
+  double extent;  // radius of the sphere around center containing all distributions
+  std::vector<size_t> dists;  // distributions in this box (and its children)
+  std::vector<size_t> children;
+  bool is_leaf() const { return children.empty(); }
+};
 
-      for (auto s2 = 0; s2 <= s1; ++s2, ++s12) {
-        if (s12 % nthreads != thread_id) continue;
+void build_octree(std::vector<Box>& boxes, size_t b,
+                  const std::vector<Distribution>& dists,
+                  size_t max_leaf_size, int max_depth) {
+  // compute the extent of the box
+  {
+    auto& box = boxes[b];
+    box.extent = 0.0;
+    for (auto d : box.dists) {
+      const auto& dist = dists[d];
+      double r2 = 0.0;
+      for (int xyz = 0; xyz != 3; ++xyz)
+        r2 += (dist.center[xyz] - box.center[xyz]) *
+              (dist.center[xyz] - box.center[xyz]);
+      box.extent = std::max(box.extent, std::sqrt(r2) + dist.extent);
+    }
+  }
+  if (boxes[b].dists.size() <= max_leaf_size || max_depth == 0) return;
 
-        auto bf2 = shell2bf[s2];
-        auto n2 = bs[s2].size();
+  // subdivide
+  std::array<std::vector<size_t>, 8> octants;
+  for (auto d : boxes[b].dists) {
+    int octant = 0;
+    for (int xyz = 0; xyz != 3; ++xyz)
+      if (dists[d].center[xyz] > boxes[b].center[xyz]) octant |= (1 << xyz);
+    octants[octant].push_back(d);
+  }
+  for (int o = 0; o != 8; ++o) {
+    if (octants[o].empty()) continue;
+    Box child;
+    child.half_size = boxes[b].half_size / 2;
+    for (int xyz = 0; xyz != 3; ++xyz)
+      child.center[xyz] = boxes[b].center[xyz] +
+                          ((o & (1 << xyz)) ? 1 : -1) * child.half_size;
+    child.dists = std::move(octants[o]);
+    boxes.push_back(std::move(child));
+    const auto c = boxes.size() - 1;
+    boxes[b].children.push_back(c);
+    build_octree(boxes, c, dists, max_leaf_size, max_depth - 1);
+  }
+}
 
-        // compute shell pair; return is the pointer to the buffer
-        engine.compute(bs[s1], bs[s2]);
-        if (buf[0] == nullptr)
-          continue; // if all integrals screened out, skip to next shell set
-
-        // "map" buffer to a const Eigen Matrix, and copy it to the
-        // corresponding blocks of the result
-        Eigen::Map<const Matrix> buf_mat(buf[0], n1, n2);
-        result.block(bf1, bf2, n1, n2) = buf_mat;
-        if (s1 != s2)  // if s1 >= s2, copy {s1,s2} to the corresponding {s2,s1}
-                       // block, note the transpose!
-          result.block(bf2, bf1, n2, n1) = buf_mat.transpose();
-      }
+// dual tree traversal: sorts interactions of boxes a and b into near-field
+// (pairs of leaves) and far-field (pairs of well-separated boxes)
+void traverse(const std::vector<Box>& boxes, size_t a, size_t b, double theta,
+              std::vector<std::pair<size_t, size_t>>& near,
+              std::vector<std::pair<size_t, size_t>>& far) {
+  const auto& A = boxes[a];
+  const auto& B = boxes[b];
+  if (a == b) {
+    if (A.is_leaf())
+      near.emplace_back(a, a);
+    else {
+      for (auto c1 = A.children.begin(); c1 != A.children.end(); ++c1)
+        for (auto c2 = c1; c2 != A.children.end(); ++c2)
+          traverse(boxes, *c1, *c2, theta, near, far);
     }
-  };  // compute lambda
-
-  libint2::parallel_do(compute);
+    return;
+  }
 
-  return result;
+  double R2 = 0.0;
+  for (int xyz = 0; xyz != 3; ++xyz)
+    R2 += (A.center[xyz] - B.center[xyz]) * (A.center[xyz] - B.center[xyz]);
+  if (A.extent + B.extent < theta * std::sqrt(R2)) {
+    far.emplace_back(a, b);
+    return;
+  }
+  if (A.is_leaf() && B.is_leaf()) {
+    near.emplace_back(a, b);
+    return;
+  }
+  // split the larger box
+  const auto split_a =
+      B.is_leaf() || (!A.is_leaf() && A.extent >= B.extent);
+  if (split_a)
+    for (auto c : A.children) traverse(boxes, c, b, theta, near, far);
+  else
+    for (auto c : B.children) traverse(boxes, a, c, theta, near, far);
 }
 
-Matrix compute_2body_fock(const BasisSet& obs, const Matrix& D,
-                          double precision, const Matrix& Schwarz) {
+}  // namespace fmm
+
+Matrix compute_2body_J_fmm(const BasisSet& obs, const Matrix& D,
+                           double precision, const Matrix& Schwarz,
+                           double theta) {
   const auto n = obs.nbf();
   const auto nshells = obs.size();
   using libint2::nthreads;
-  std::vector<Matrix> G(nthreads, Matrix::Zero(n, n));
+  using fmm::complex;
+  const auto shell2bf = obs.shell2bf();
 
   const auto do_schwarz_screen = Schwarz.cols() != 0 && Schwarz.rows() != 0;
   Matrix D_shblk_norm =
       compute_shellblock_norm(obs, D);  // matrix of infty-norms of shell blocks
 
-  auto fock_precision = precision;
-  // engine precision controls primitive truncation, assume worst-case scenario
-  // (all primitive combinations add up constructively)
-  auto max_nprim = obs.max_nprim();
-  auto max_nprim4 = max_nprim * max_nprim * max_nprim * max_nprim;
-  auto engine_precision = std::min(fock_precision / D_shblk_norm.maxCoeff(),
-                                   std::numeric_limits<double>::epsilon()) /
-                          max_nprim4;
-  assert(engine_precision > max_engine_precision &&
-      "using precomputed shell pair data limits the max engine precision"
-  " ... make max_engine_precision smalle and recompile");
-
-  // construct the 2-electron repulsion integrals engine pool
-  using libint2::Engine;
-  std::vector<Engine> engines(nthreads);
-  engines[0] = Engine(Operator::coulomb, obs.max_nprim(), obs.max_l(), 0);
-  engines[0].set_precision(engine_precision);  // shellset-dependent precision
-                                               // control will likely break
-                                               // positive definiteness
-                                               // stick with this simple recipe
-  std::cout << "compute_2body_fock:precision = " << precision << std::endl;
-  std::cout << "Engine::precision = " << engines[0].precision() << std::endl;
-  for (size_t i = 1; i != nthreads; ++i) {
-    engines[i] = engines[0];
+  // the highest order of multipoles
+  const int p = MULTIPOLE_MAX_ORDER;
+  const auto nmoments = (p + 1) * (p + 1);
+
+  // 1. charge distributions of non-negligible shell pairs; their extents are
+  //    determined by the most diffuse primitive pairs
+  std::vector<fmm::Distribution> dists;
+  const auto ln_precision = std::log(precision);
+  for (auto s1 = 0l; s1 != nshells; ++s1) {
+    auto sp12_iter = obs_shellpair_data.at(s1).begin();
+    for (const auto& s2 : obs_shellpair_list[s1]) {
+      fmm::Distribution dist;
+      dist.s1 = s1;
+      dist.s2 = s2;
+      dist.sp = sp12_iter->get();
+      ++sp12_iter;
+      const auto& primpairs = dist.sp->primpairs;
+      if (primpairs.empty()) continue;
+      std::array<double, 3> Pmin, Pmax;
+      for (int xyz = 0; xyz != 3; ++xyz) {
+        Pmin[xyz] = Pmax[xyz] = primpairs[0].P[xyz];
+        for (const auto& pp : primpairs) {
+          Pmin[xyz] = std::min(Pmin[xyz], pp.P[xyz]);
+          Pmax[xyz] = std::max(Pmax[xyz], pp.P[xyz]);
+        }
+        dist.center[xyz] = (Pmin[xyz] + Pmax[xyz]) / 2;
+      }
+      dist.extent = 0.0;
+      for (const auto& pp : primpairs) {
+        double r2 = 0.0;
+        for (int xyz = 0; xyz != 3; ++xyz)
+          r2 += (pp.P[xyz] - dist.center[xyz]) * (pp.P[xyz] - dist.center[xyz]);
+        // exp(-gamma r^2) < precision outside this radius
+        const auto r_tail = std::sqrt(-ln_precision * pp.one_over_gamma);
+        dist.extent = std::max(dist.extent, std::sqrt(r2) + r_tail);
+      }
+      dists.push_back(dist);
+    }
   }
-  std::atomic<size_t> num_ints_computed{0};
 
-#if defined(REPORT_INTEGRAL_TIMINGS)
-  std::vector<libint2::Timers<1>> timers(nthreads);
-#endif
+  // 2. the octree
+  std::vector<fmm::Box> boxes(1);
+  {
+    std::array<double, 3> lo, hi;
+    for (int xyz = 0; xyz != 3; ++xyz) {
+      lo[xyz] = std::numeric_limits<double>::max();
+      hi[xyz] = std::numeric_limits<double>::lowest();
+      for (const auto& d : dists) {
+        lo[xyz] = std::min(lo[xyz], d.center[xyz]);
+        hi[xyz] = std::max(hi[xyz], d.center[xyz]);
+      }
+    }
+    auto& root = boxes[0];
+    root.half_size = 0.0;
+    for (int xyz = 0; xyz != 3; ++xyz) {
+      root.center[xyz] = (lo[xyz] + hi[xyz]) / 2;
+      root.half_size = std::max(root.half_size, (hi[xyz] - lo[xyz]) / 2);
+    }
+    root.dists.resize(dists.size());
+    std::iota(root.dists.begin(), root.dists.end(), 0);
+  }
+  const size_t max_leaf_size = 16;
+  const int max_depth = 12;
+  fmm::build_octree(boxes, 0, dists, max_leaf_size, max_depth);
 
-  auto shell2bf = obs.shell2bf();
+  std::vector<std::pair<size_t, size_t>> near, far;
+  fmm::traverse(boxes, 0, 0, theta, near, far);
 
-  auto lambda = [&](int thread_id) {
+  // boxes that are sources/targets of multipole interactions
+  std::vector<bool> box_is_far(boxes.size(), false);
+  for (const auto& ab : far) box_is_far[ab.first] = box_is_far[ab.second] = true;
 
-    auto& engine = engines[thread_id];
-    auto& g = G[thread_id];
-    const auto& buf = engine.results();
+  // engines
+  using libint2::Engine;
+  const auto max_nprim = obs.max_nprim();
+  const auto max_nprim4 = max_nprim * max_nprim * max_nprim * max_nprim;
+  const auto engine_precision =
+      std::max(std::min(precision / D_shblk_norm.maxCoeff(),
+                        std::numeric_limits<double>::epsilon()) /
+                   max_nprim4,
+               max_engine_precision);
+  // the multipole moment engine of thread thread_id
+  auto multipole_engine = [&](int thread_id) -> Engine& {
+    return engine_pool().get(thread_id, Operator::sphemultipole, max_nprim,
+                             obs.max_l(), 0);
+  };
+
+  // computes the real multipole moment integrals of distribution d around O
+  // and calls op(f1, f2, moments) for each function pair
+  auto foreach_moment = [&](Engine& mengine, const fmm::Distribution& d,
+                            const std::array<double, 3>& O,
+                            const std::function<void(size_t, size_t,
+                                                     const double*)>& op) {
+    mengine.set_params(O);
+    const auto& buf = mengine.compute(obs[d.s1], obs[d.s2]);
+    const auto n1 = obs[d.s1].size();
+    const auto n2 = obs[d.s2].size();
+    std::vector<double> moments(nmoments);
+    for (auto f1 = 0ul, f12 = 0ul; f1 != n1; ++f1)
+      for (auto f2 = 0ul; f2 != n2; ++f2, ++f12) {
+        for (int k = 0; k != nmoments; ++k) moments[k] = buf[k][f12];
+        op(shell2bf[d.s1] + f1, shell2bf[d.s2] + f2, moments.data());
+      }
+  };
+
+  // 3. multipole moments of the electron density in each far-field box
+  std::vector<std::vector<complex>> M(boxes.size());
+  auto compute_multipoles = [&](int thread_id) {
+    auto& mengine = multipole_engine(thread_id);
+    std::vector<double> real_moments(nmoments);
+    for (size_t b = 0; b != boxes.size(); ++b) {
+      if (b % nthreads != thread_id || !box_is_far[b]) continue;
+      std::fill(real_moments.begin(), real_moments.end(), 0.0);
+      for (auto d : boxes[b].dists) {
+        const auto deg = (dists[d].s1 == dists[d].s2) ? 1.0 : 2.0;
+        foreach_moment(mengine, dists[d], boxes[b].center,
+                       [&](size_t bf1, size_t bf2, const double* m) {
+                         const auto Dv = deg * D(bf1, bf2);
+                         for (int k = 0; k != nmoments; ++k)
+                           real_moments[k] += Dv * m[k];
+                       });
+      }
+      M[b].resize(nmoments);
+      fmm::real_to_complex(p, real_moments.data(), M[b].data());
+    }
+  };
+  libint2::parallel_do(compute_multipoles);
+
+  // 4. far field: M2L translations into local expansions
+  std::vector<std::vector<std::vector<complex>>> L(
+      nthreads, std::vector<std::vector<complex>>(boxes.size()));
+  auto compute_far = [&](int thread_id) {
+    auto& L_t = L[thread_id];
+    std::vector<complex> I;
+    for (size_t i = 0; i != far.size(); ++i) {
+      if (i % nthreads != thread_id) continue;
+      const auto a = far[i].first;
+      const auto b = far[i].second;
+      std::array<double, 3> R_ab;
+      for (int xyz = 0; xyz != 3; ++xyz)
+        R_ab[xyz] = boxes[a].center[xyz] - boxes[b].center[xyz];
+      fmm::irregular_harmonics(2 * p, R_ab, I);
+      if (L_t[a].empty()) L_t[a].resize(nmoments, 0.0);
+      fmm::m2l(p, M[b].data(), I, L_t[a].data());
+      // I_{lm}(-R) = (-1)^l I_{lm}(R)
+      for (int l = 0; l <= 2 * p; ++l)
+        if (l % 2)
+          for (int m = -l; m <= l; ++m) I[fmm::lm_index(l, m)] *= -1.0;
+      if (L_t[b].empty()) L_t[b].resize(nmoments, 0.0);
+      fmm::m2l(p, M[a].data(), I, L_t[b].data());
+    }
+  };
+  libint2::parallel_do(compute_far);
 
+  // 5. near field: exact integrals, and evaluation of the local expansions
+  std::vector<Matrix> J(nthreads, Matrix::Zero(n, n));
 #if defined(REPORT_INTEGRAL_TIMINGS)
-    auto& timer = timers[thread_id];
-    timer.clear();
-    timer.set_now_overhead(25);
+  std::atomic<size_t> num_ints_computed{0};
 #endif
 
-    // loop over permutationally-unique set of shells
-    for (auto s1 = 0l, s1234 = 0l; s1 != nshells; ++s1) {
-      auto bf1_first = shell2bf[s1];  // first basis function in this shell
-      auto n1 = obs[s1].size();       // number of basis functions in this shell
-
-      auto sp12_iter = obs_shellpair_data.at(s1).begin();
+  auto compute_near = [&](int thread_id) {
+    auto& engine = engine_pool().get(thread_id, Operator::coulomb, max_nprim,
+                                     obs.max_l(), 0, engine_precision);
+    auto& mengine = multipole_engine(thread_id);
+    auto& j = J[thread_id];
+    const auto& buf = engine.results();
 
-      for (const auto& s2 : obs_shellpair_list[s1]) {
-        auto bf2_first = shell2bf[s2];
-        auto n2 = obs[s2].size();
+    // J(a,b) += (ab|cd) D(c,d) deg_cd, J(c,d) += (ab|cd) D(a,b) deg_ab
+    auto contract = [&](const fmm::Distribution& d12,
+                        const fmm::Distribution& d34, bool same) {
+      const auto s1 = d12.s1, s2 = d12.s2, s3 = d34.s1, s4 = d34.s2;
+      if (do_schwarz_screen &&
+          std::max(D_shblk_norm(s1, s2), D_shblk_norm(s3, s4)) *
+                  Schwarz(s1, s2) * Schwarz(s3, s4) <
+              precision)
+        return;
+      engine.compute2<Operator::coulomb, BraKet::xx_xx, 0>(
+          obs[s1], obs[s2], obs[s3], obs[s4], d12.sp, d34.sp);
+      const auto* buf_1234 = buf[0];
+      if (buf_1234 == nullptr) return;
+      const auto n1 = obs[s1].size(), n2 = obs[s2].size();
+      const auto n3 = obs[s3].size(), n4 = obs[s4].size();
+#if defined(REPORT_INTEGRAL_TIMINGS)
+      num_ints_computed += n1 * n2 * n3 * n4;
+#endif
+      const auto deg12 = (s1 == s2) ? 1.0 : 2.0;
+      const auto deg34 = (s3 == s4) ? 1.0 : 2.0;
+      for (auto f1 = 0ul, f1234 = 0ul; f1 != n1; ++f1) {
+        const auto bf1 = f1 + shell2bf[s1];
+        for (auto f2 = 0ul; f2 != n2; ++f2) {
+          const auto bf2 = f2 + shell2bf[s2];
+          for (auto f3 = 0ul; f3 != n3; ++f3) {
+            const auto bf3 = f3 + shell2bf[s3];
+            for (auto f4 = 0ul; f4 != n4; ++f4, ++f1234) {
+              const auto bf4 = f4 + shell2bf[s4];
+              const auto value = buf_1234[f1234];
+              j(bf1, bf2) += deg34 * D(bf3, bf4) * value;
+              if (!same) j(bf3, bf4) += deg12 * D(bf1, bf2) * value;
+            }
+          }
+        }
+      }
+    };
+
+    for (size_t i = 0; i != near.size(); ++i) {
+      if (i % nthreads != thread_id) continue;
+      const auto& A = boxes[near[i].first];
+      const auto& B = boxes[near[i].second];
+      if (near[i].first == near[i].second) {
+        for (auto d1 = A.dists.begin(); d1 != A.dists.end(); ++d1)
+          for (auto d2 = d1; d2 != A.dists.end(); ++d2)
+            contract(dists[*d1], dists[*d2], d1 == d2);
+      } else {
+        for (auto d1 : A.dists)
+          for (auto d2 : B.dists) contract(dists[d1], dists[d2], false);
+      }
+    }
 
-        const auto* sp12 = sp12_iter->get();
-        ++sp12_iter;
+    // J(a,b) += Re \sum_{lm} R^*_{lm}(ab) L_{lm}
+    std::vector<complex> L_b(nmoments);
+    std::vector<double> w(nmoments);
+    for (size_t b = 0; b != boxes.size(); ++b) {
+      if (b % nthreads != thread_id || !box_is_far[b]) continue;
+      std::fill(L_b.begin(), L_b.end(), 0.0);
+      for (int t = 0; t != nthreads; ++t)
+        if (!L[t][b].empty())
+          for (int k = 0; k != nmoments; ++k) L_b[k] += L[t][b][k];
+      fmm::complex_to_real_functional(p, L_b.data(), w.data());
+      for (auto d : boxes[b].dists) {
+        foreach_moment(mengine, dists[d], boxes[b].center,
+                       [&](size_t bf1, size_t bf2, const double* m) {
+                         double value = 0.0;
+                         for (int k = 0; k != nmoments; ++k)
+                           value += w[k] * m[k];
+                         j(bf1, bf2) += value;
+                       });
+      }
+    }
+  };  // end of compute_near
+  libint2::parallel_do(compute_near);
+
+  for (size_t i = 1; i != nthreads; ++i) J[0] += J[i];
+
+  // only the shell blocks {s1,s2} with s1 >= s2 were computed, the diagonal
+  // blocks are symmetric
+  Matrix result = J[0];
+  for (const auto& d : dists) {
+    const auto n1 = obs[d.s1].size(), n2 = obs[d.s2].size();
+    if (d.s1 != d.s2)
+      result.block(shell2bf[d.s2], shell2bf[d.s1], n2, n1) =
+          J[0].block(shell2bf[d.s1], shell2bf[d.s2], n1, n2).transpose();
+  }
 
-        const auto Dnorm12 = do_schwarz_screen ? D_shblk_norm(s1, s2) : 0.;
+#if defined(REPORT_INTEGRAL_TIMINGS)
+  std::cout << "compute_2body_J_fmm: # of boxes = " << boxes.size()
+            << ", # of near/far box pairs = " << near.size() << "/"
+            << far.size() << ", # of integrals = " << num_ints_computed
+            << std::endl;
+#endif
 
-        for (auto s3 = 0; s3 <= s1; ++s3) {
-          auto bf3_first = shell2bf[s3];
-          auto n3 = obs[s3].size();
+  return result;
+}
 
-          const auto Dnorm123 =
-              do_schwarz_screen
-                  ? std::max(D_shblk_norm(s1, s3),
-                             std::max(D_shblk_norm(s2, s3), Dnorm12))
-                  : 0.;
+namespace cosx {
 
-          auto sp34_iter = obs_shellpair_data.at(s3).begin();
+/// a grid point and its weight
+struct GridPoint {
+  std::array<double, 3> r;
+  double weight;
+};
 
-          const auto s4_max = (s1 == s3) ? s2 : s3;
-          for (const auto& s4 : obs_shellpair_list[s3]) {
-            if (s4 > s4_max)
-              break;  // for each s3, s4 are stored in monotonically increasing
-                      // order
+// Gauss-Legendre quadrature on [-1,1], by Newton iteration
+void gauss_legendre(size_t n, std::vector<double>& x, std::vector<double>& w) {
+  x.resize(n);
+  w.resize(n);
+  for (size_t i = 0; i != n; ++i) {
+    auto z = std::cos(M_PI * (i + 0.75) / (n + 0.5));
+    double dp;
+    for (int iter = 0; iter != 100; ++iter) {
+      double p0 = 1.0, p1 = z;
+      for (size_t k = 2; k <= n; ++k) {
+        const auto p2 = ((2 * k - 1) * z * p1 - (k - 1) * p0) / k;
+        p0 = p1;
+        p1 = p2;
+      }
+      if (n == 1) p1 = z, p0 = 1.0;
+      dp = n * (z * p1 - p0) / (z * z - 1);
+      const auto dz = p1 / dp;
+      z -= dz;
+      if (std::abs(dz) < 1e-15) break;
+    }
+    x[i] = z;
+    w[i] = 2 / ((1 - z * z) * dp * dp);
+  }
+}
 
-            // must update the iter even if going to skip s4
-            const auto* sp34 = sp34_iter->get();
-            ++sp34_iter;
+// Becke's molecular grid (A. D. Becke, J Chem Phys 88, 2547 (1988)): atomic
+// grids made of Gauss-Chebyshev radial and (Gauss-Legendre x trapezoidal)
+// angular quadratures, combined with fuzzy Voronoi cell weights
+std::vector<GridPoint> make_becke_grid(const std::vector<Atom>& atoms,
+                                       size_t nrad, size_t ntheta) {
+  std::vector<double> ct, ct_w;
+  gauss_legendre(ntheta, ct, ct_w);
+  const auto nphi = 2 * ntheta;
 
-            if ((s1234++) % nthreads != thread_id) continue;
+  std::vector<GridPoint> grid;
+  const auto natoms = atoms.size();
+  std::vector<double> P(natoms);
+  for (size_t a = 0; a != natoms; ++a) {
+    const std::array<double, 3> A = {{atoms[a].x, atoms[a].y, atoms[a].z}};
+    const auto R_m = atoms[a].atomic_number == 1 ? 0.5 : 1.0;
+    for (size_t i = 1; i <= nrad; ++i) {
+      // Gauss-Chebyshev quadrature of the second kind, mapped to [0,infty)
+      const auto t = i * M_PI / (nrad + 1);
+      const auto x = std::cos(t);
+      const auto w_x = M_PI / (nrad + 1) * std::sin(t);  // includes 1/sqrt(1-x^2)
+      const auto r = R_m * (1 + x) / (1 - x);
+      const auto w_r = w_x * 2 * R_m / ((1 - x) * (1 - x)) * r * r;
+      for (size_t it = 0; it != ntheta; ++it) {
+        const auto sin_theta = std::sqrt(1 - ct[it] * ct[it]);
+        for (size_t ip = 0; ip != nphi; ++ip) {
+          const auto phi = 2 * M_PI * ip / nphi;
+          GridPoint pt;
+          pt.r = {{A[0] + r * sin_theta * std::cos(phi),
+                   A[1] + r * sin_theta * std::sin(phi), A[2] + r * ct[it]}};
+          // fuzzy cell weights
+          for (size_t b = 0; b != natoms; ++b) P[b] = 1.0;
+          for (size_t b = 0; b != natoms; ++b) {
+            const auto r_b = std::sqrt(std::pow(pt.r[0] - atoms[b].x, 2) +
+                                       std::pow(pt.r[1] - atoms[b].y, 2) +
+                                       std::pow(pt.r[2] - atoms[b].z, 2));
+            for (size_t c = 0; c != natoms; ++c) {
+              if (b == c) continue;
+              const auto r_c = std::sqrt(std::pow(pt.r[0] - atoms[c].x, 2) +
+                                         std::pow(pt.r[1] - atoms[c].y, 2) +
+                                         std::pow(pt.r[2] - atoms[c].z, 2));
+              const auto R_bc = std::sqrt(std::pow(atoms[b].x - atoms[c].x, 2) +
+                                          std::pow(atoms[b].y - atoms[c].y, 2) +
+                                          std::pow(atoms[b].z - atoms[c].z, 2));
+              auto mu = (r_b - r_c) / R_bc;
+              for (int k = 0; k != 3; ++k) mu = 1.5 * mu - 0.5 * mu * mu * mu;
+              P[b] *= 0.5 * (1 - mu);
+            }
+          }
+          const auto P_sum = std::accumulate(P.begin(), P.end(), 0.0);
+          pt.weight = w_r * ct_w[it] * (2 * M_PI / nphi) * P[a] / P_sum;
+          if (pt.weight > 1e-15) grid.push_back(pt);
+        }
+      }
+    }
+  }
+  return grid;
+}
 
-            const auto Dnorm1234 =
-                do_schwarz_screen
-                    ? std::max(
-                          D_shblk_norm(s1, s4),
-                          std::max(D_shblk_norm(s2, s4),
-                                   std::max(D_shblk_norm(s3, s4), Dnorm123)))
-                    : 0.;
+// computes values of all basis functions at point r
+void compute_ao_values(const BasisSet& obs, const std::array<double, 3>& r,
+                       double* values) {
+  std::vector<double> cart;
+  for (const auto& shell : obs) {
+    const auto dx = r[0] - shell.O[0];
+    const auto dy = r[1] - shell.O[1];
+    const auto dz = r[2] - shell.O[2];
+    const auto r2 = dx * dx + dy * dy + dz * dz;
+    for (const auto& contr : shell.contr) {
+      double radial = 0.0;
+      for (size_t p = 0; p != shell.nprim(); ++p)
+        radial += contr.coeff[p] * std::exp(-shell.alpha[p] * r2);
+      const auto l = contr.l;
+      // Cartesian components in the standard Libint order
+      cart.resize((l + 1) * (l + 2) / 2);
+      for (int i = 0, ixyz = 0; i <= l; ++i) {
+        const auto nx = l - i;
+        for (int nz = 0; nz <= i; ++nz, ++ixyz) {
+          const auto ny = i - nz;
+          cart[ixyz] =
+              radial * std::pow(dx, nx) * std::pow(dy, ny) * std::pow(dz, nz);
+        }
+      }
+      if (contr.pure) {
+        libint2::solidharmonics::transform_first(l, 1, cart.data(), values);
+        values += 2 * l + 1;
+      } else {
+        std::copy(cart.begin(), cart.end(), values);
+        values += cart.size();
+      }
+    }
+  }
+}
 
-            if (do_schwarz_screen &&
-                Dnorm1234 * Schwarz(s1, s2) * Schwarz(s3, s4) <
-                    fock_precision)
-              continue;
+}  // namespace cosx
 
-            auto bf4_first = shell2bf[s4];
-            auto n4 = obs[s4].size();
+Matrix compute_2body_K_seminumerical(const BasisSet& obs,
+                                     const std::vector<Atom>& atoms,
+                                     const Matrix& D, size_t nrad,
+                                     size_t ntheta, double precision) {
+  const auto n = obs.nbf();
+  const auto nshells = obs.size();
+  using libint2::nthreads;
+  const auto shell2bf = obs.shell2bf();
 
-            num_ints_computed += n1 * n2 * n3 * n4;
+  const auto grid = cosx::make_becke_grid(atoms, nrad, ntheta);
 
-            // compute the permutational degeneracy (i.e. # of equivalents) of
-            // the given shell set
-            auto s12_deg = (s1 == s2) ? 1.0 : 2.0;
-            auto s34_deg = (s3 == s4) ? 1.0 : 2.0;
-            auto s12_34_deg = (s1 == s3) ? (s2 == s4 ? 1.0 : 2.0) : 2.0;
-            auto s1234_deg = s12_deg * s34_deg * s12_34_deg;
+  // the shells that form a non-negligible pair with each shell, i.e. the
+  // shell-pair list with both orders of the shells
+  std::vector<std::vector<size_t>> shell_neighbors(nshells);
+  for (size_t s1 = 0; s1 != nshells; ++s1)
+    for (const auto& s2 : obs_shellpair_list[s1]) {
+      shell_neighbors[s1].push_back(s2);
+      if (s2 != s1) shell_neighbors[s2].push_back(s1);
+    }
 
+  // points are processed in batches, so that the last step is a matrix
+  // product
+  const size_t batch_size = 128;
+  const auto nbatches = (grid.size() + batch_size - 1) / batch_size;
+  std::vector<Matrix> K(nthreads, Matrix::Zero(n, n));
 #if defined(REPORT_INTEGRAL_TIMINGS)
-            timer.start(0);
+  std::atomic<size_t> num_ints_computed{0};
 #endif
 
-            engine.compute2<Operator::coulomb, BraKet::xx_xx, 0>(
-                obs[s1], obs[s2], obs[s3], obs[s4], sp12, sp34);
-            const auto* buf_1234 = buf[0];
-            if (buf_1234 == nullptr)
-              continue; // if all integrals screened out, skip to next quartet
-
+  auto compute = [&](int thread_id) {
+    // potential integrals of unit charges located at the grid points
+    auto& engine = engine_pool().get(thread_id, Operator::nuclear,
+                                     obs.max_nprim(), obs.max_l(), 0);
+    const auto& buf = engine.results();
+    Matrix X(batch_size, n);   // basis function values
+    Matrix XW(batch_size, n);  // same, scaled by the grid weights
+    Matrix G(batch_size, n);
+    std::vector<double> F_shell_norm(nshells);
+    std::vector<size_t> sig_shells;  // shells with non-negligible F(g,s)
+    std::vector<bool> is_sig_shell(nshells);
+    std::vector<std::pair<double, std::array<double, 3>>> unit_charge(1);
+    unit_charge[0].first = -1.0;  // Engine<nuclear> computes -q/|r-C|
+
+    for (size_t batch = 0; batch != nbatches; ++batch) {
+      if (batch % nthreads != thread_id) continue;
+      const auto g_first = batch * batch_size;
+      const auto npts = std::min(batch_size, grid.size() - g_first);
+
+      for (size_t g = 0; g != npts; ++g) {
+        cosx::compute_ao_values(obs, grid[g_first + g].r, &X(g, 0));
+        XW.row(g) = X.row(g) * grid[g_first + g].weight;
+      }
+      // F(g,s) = \sum_r X(g,r) D(r,s)
+      Matrix F = X.topRows(npts) * D;
+      G.setZero();
+
+      for (size_t g = 0; g != npts; ++g) {
+        // F(g,s) is negligible unless basis functions that overlap (through
+        // D) shell s are non-negligible at the point, hence only the pairs
+        // that include one of the few shells near the point are visited
+        sig_shells.clear();
+        for (auto s = 0l; s != nshells; ++s) {
+          F_shell_norm[s] = F.row(g)
+                                .segment(shell2bf[s], obs[s].size())
+                                .lpNorm<Eigen::Infinity>();
+          is_sig_shell[s] = F_shell_norm[s] >= precision;
+          if (is_sig_shell[s]) sig_shells.push_back(s);
+        }
+        if (sig_shells.empty()) continue;
+
+        unit_charge[0].second = grid[g_first + g].r;
+        engine.set_params(unit_charge);
+
+        // G(g,a) = \sum_b A_{ab}(g) F(g,b), A_{ab}(g) = (a|1/|r-r_g||b)
+        for (const auto& s1 : sig_shells) {
+          const auto bf1 = shell2bf[s1];
+          const auto n1 = obs[s1].size();
+          for (const auto& s2 : shell_neighbors[s1]) {
+            // a pair of 2 significant shells is visited from the larger one
+            if (is_sig_shell[s2] && s2 > s1) continue;
+            const auto bf2 = shell2bf[s2];
+            const auto n2 = obs[s2].size();
+            engine.compute(obs[s1], obs[s2]);
 #if defined(REPORT_INTEGRAL_TIMINGS)
-            timer.stop(0);
+            num_ints_computed += n1 * n2;
 #endif
-
-            // 1) each shell set of integrals contributes up to 6 shell sets of
-            // the Fock matrix:
-            //    F(a,b) += (ab|cd) * D(c,d)
-            //    F(c,d) += (ab|cd) * D(a,b)
-            //    F(b,d) -= 1/4 * (ab|cd) * D(a,c)
-            //    F(b,c) -= 1/4 * (ab|cd) * D(a,d)
-            //    F(a,c) -= 1/4 * (ab|cd) * D(b,d)
-            //    F(a,d) -= 1/4 * (ab|cd) * D(b,c)
-            // 2) each permutationally-unique integral (shell set) must be
-            // scaled by its degeneracy,
-            //    i.e. the number of the integrals/sets equivalent to it
-            // 3) the end result must be symmetrized
-            for (auto f1 = 0, f1234 = 0; f1 != n1; ++f1) {
-              const auto bf1 = f1 + bf1_first;
-              for (auto f2 = 0; f2 != n2; ++f2) {
-                const auto bf2 = f2 + bf2_first;
-                for (auto f3 = 0; f3 != n3; ++f3) {
-                  const auto bf3 = f3 + bf3_first;
-                  for (auto f4 = 0; f4 != n4; ++f4, ++f1234) {
-                    const auto bf4 = f4 + bf4_first;
-
-                    const auto value = buf_1234[f1234];
-
-                    const auto value_scal_by_deg = value * s1234_deg;
-
-                    g(bf1, bf2) += D(bf3, bf4) * value_scal_by_deg;
-                    g(bf3, bf4) += D(bf1, bf2) * value_scal_by_deg;
-                    g(bf1, bf3) -= 0.25 * D(bf2, bf4) * value_scal_by_deg;
-                    g(bf2, bf4) -= 0.25 * D(bf1, bf3) * value_scal_by_deg;
-                    g(bf1, bf4) -= 0.25 * D(bf2, bf3) * value_scal_by_deg;
-                    g(bf2, bf3) -= 0.25 * D(bf1, bf4) * value_scal_by_deg;
-                  }
-                }
-              }
-            }
+            Eigen::Map<const Matrix> A(buf[0], n1, n2);
+            G.row(g).segment(bf1, n1) +=
+                A * F.row(g).segment(bf2, n2).transpose();
+            if (s1 != s2)
+              G.row(g).segment(bf2, n2) +=
+                  A.transpose() * F.row(g).segment(bf1, n1).transpose();
           }
         }
       }
-    }
 
-  };  // end of lambda
+      // K(a,b) += \sum_g w_g X(g,a) G(g,b)
+      K[thread_id] +=
+          XW.topRows(npts).transpose() * G.topRows(npts);
+    }
+  };  // end of compute
 
-  libint2::parallel_do(lambda);
+  libint2::parallel_do(compute);
 
-  // accumulate contributions from all threads
-  for (size_t i = 1; i != nthreads; ++i) {
-    G[0] += G[i];
-  }
+  for (size_t i = 1; i != nthreads; ++i) K[0] += K[i];
 
 #if defined(REPORT_INTEGRAL_TIMINGS)
-  double time_for_ints = 0.0;
-  for (auto& t : timers) {
-    time_for_ints += t.read(0);
-  }
-  std::cout << "time for integrals = " << time_for_ints << std::endl;
-  for (int t = 0; t != nthreads; ++t) engines[t].print_timers();
+  std::cout << "compute_2body_K_seminumerical: # of grid points = "
+            << grid.size() << ", # of integrals = " << num_ints_computed
+            << std::endl;
 #endif
 
-  Matrix GG = 0.5 * (G[0] + G[0].transpose());
-
-  std::cout << "# of integrals = " << num_ints_computed << std::endl;
-
-  // symmetrize the result and return
-  return GG;
+  // the seminumerical K is not exactly symmetric
+  return 0.5 * (K[0] + K[0].transpose());
 }
 
 #if LIBINT2_DERIV_ERI_ORDER
@@ -1745,20 +1914,11 @@ std::vector<Matrix> compute_2body_fock_deriv(const BasisSet& obs,
                                    std::numeric_limits<double>::epsilon()) /
                           max_nprim4;
 
-  // construct the 2-electron repulsion integrals engine pool
-  using libint2::Engine;
-  std::vector<Engine> engines(nthreads);
-  engines[0] =
-      Engine(Operator::coulomb, obs.max_nprim(), obs.max_l(), deriv_order);
-  engines[0].set_precision(engine_precision);  // shellset-dependent precision
-                                               // control will likely break
-                                               // positive definiteness
-                                               // stick with this simple recipe
+  // the 2-electron repulsion integrals engines come from the pool
+  // N.B. shellset-dependent precision control will likely break positive
+  // definiteness, stick with this simple recipe
   std::cout << "compute_2body_fock:precision = " << precision << std::endl;
-  std::cout << "Engine::precision = " << engines[0].precision() << std::endl;
-  for (size_t i = 1; i != nthreads; ++i) {
-    engines[i] = engines[0];
-  }
+  std::cout << "Engine::precision = " << engine_precision << std::endl;
   std::atomic<size_t> num_ints_computed{0};
 
 #if defined(REPORT_INTEGRAL_TIMINGS)
@@ -1770,7 +1930,9 @@ std::vector<Matrix> compute_2body_fock_deriv(const BasisSet& obs,
 
   auto lambda = [&](int thread_id) {
 
-    auto& engine = engines[thread_id];
+    auto& engine = engine_pool().get(thread_id, Operator::coulomb,
+                                     obs.max_nprim(), obs.max_l(), deriv_order,
+                                     engine_precision);
     const auto& buf = engine.results();
 
 #if defined(REPORT_INTEGRAL_TIMINGS)
@@ -1967,7 +2129,11 @@ std::vector<Matrix> compute_2body_fock_deriv(const BasisSet& obs,
     time_for_ints += t.read(0);
   }
   std::cout << "time for integrals = " << time_for_ints << std::endl;
-  for (int t = 0; t != nthreads; ++t) engines[t].print_timers();
+  for (int t = 0; t != nthreads; ++t)
+    engine_pool()
+        .get(t, Operator::coulomb, obs.max_nprim(), obs.max_l(), deriv_order,
+             engine_precision)
+        .print_timers();
 #endif
 
   std::vector<Matrix> GG(nderiv);
@@ -2109,172 +2275,6 @@ Matrix compute_2body_fock_general(const BasisSet& obs, const Matrix& D,
   return 0.5 * (G[0] + G[0].transpose());
 }
 
-#ifdef HAVE_DENSITY_FITTING
-
-Matrix DFFockEngine::compute_2body_fock_dfC(const Matrix& Cocc) {
-
-  using libint2::nthreads;
-
-  const auto n = obs.nbf();
-  const auto ndf = dfbs.nbf();
-
-  libint2::Timers<1> wall_timer;
-  wall_timer.set_now_overhead(25);
-  std::vector<libint2::Timers<5>> timers(nthreads);
-  for(auto& timer: timers) timer.set_now_overhead(25);
-
-  typedef btas::RangeNd<CblasRowMajor, std::array<long, 1>> Range1d;
-  typedef btas::RangeNd<CblasRowMajor, std::array<long, 2>> Range2d;
-  typedef btas::Tensor<double, Range1d> Tensor1d;
-  typedef btas::Tensor<double, Range2d> Tensor2d;
-
-  // using first time? compute 3-center ints and transform to inv sqrt
-  // representation
-  if (xyK.size() == 0) {
-
-    wall_timer.start(0);
-
-    const auto nshells = obs.size();
-    const auto nshells_df = dfbs.size();
-    const auto& unitshell = libint2::Shell::unit();
-
-    // construct the 2-electron 3-center repulsion integrals engine
-    // since the code assumes (xx|xs) braket, and Engine/libint only produces
-    // (xs|xx), use 4-center engine
-    std::vector<libint2::Engine> engines(nthreads);
-    engines[0] = libint2::Engine(libint2::Operator::coulomb,
-                                 std::max(obs.max_nprim(), dfbs.max_nprim()),
-                                 std::max(obs.max_l(), dfbs.max_l()), 0);
-    engines[0].set_braket(BraKet::xs_xx);
-    for (size_t i = 1; i != nthreads; ++i) {
-      engines[i] = engines[0];
-    }
-
-    auto shell2bf = obs.shell2bf();
-    auto shell2bf_df = dfbs.shell2bf();
-
-    Tensor3d Zxy{ndf, n, n};
-
-    auto lambda = [&](int thread_id) {
-
-      auto& engine = engines[thread_id];
-      auto& timer = timers[thread_id];
-      const auto& results = engine.results();
-
-      // loop over permutationally-unique set of shells
-      for (auto s1 = 0l, s123 = 0l; s1 != nshells_df; ++s1) {
-        auto bf1_first = shell2bf_df[s1];  // first basis function in this shell
-        auto n1 = dfbs[s1].size();  // number of basis functions in this shell
-
-        for (auto s2 = 0; s2 != nshells; ++s2) {
-          auto bf2_first = shell2bf[s2];
-          auto n2 = obs[s2].size();
-          const auto n12 = n1 * n2;
-
-          for (auto s3 = 0; s3 != nshells; ++s3, ++s123) {
-            if (s123 % nthreads != thread_id) continue;
-
-            auto bf3_first = shell2bf[s3];
-            auto n3 = obs[s3].size();
-            const auto n123 = n12 * n3;
-
-            timer.start(0);
-
-            engine.compute2<Operator::coulomb, BraKet::xs_xx, 0>(
-                dfbs[s1], unitshell, obs[s2], obs[s3]);
-            const auto* buf = results[0];
-            if (buf == nullptr)
-              continue;
-
-            timer.stop(0);
-            timer.start(1);
-
-            auto lower_bound = {bf1_first, bf2_first, bf3_first};
-            auto upper_bound = {bf1_first + n1, bf2_first + n2, bf3_first + n3};
-            auto view = btas::make_view(
-                Zxy.range().slice(lower_bound, upper_bound), Zxy.storage());
-            std::copy(buf, buf + n123, view.begin());
-
-            timer.stop(1);
-          }  // s3
-        }    // s2
-      }      // s1
-
-    };  // lambda
-
-    libint2::parallel_do(lambda);
-
-    wall_timer.stop(0);
-
-    double ints_time = 0;
-    for(const auto& timer: timers) ints_time += timer.read(0);
-    std::cout << "time for Zxy integrals = " << ints_time << " (total from all threads)" << std::endl;
-    double copy_time = 0;
-    for(const auto& timer: timers) copy_time += timer.read(1);
-    std::cout << "time for copying into BTAS = " << copy_time << " (total from all threads)"<< std::endl;
-    std::cout << "wall time for Zxy integrals + copy = " << wall_timer.read(0) << std::endl;
-
-    timers[0].start(2);
-
-    Matrix V = compute_2body_2index_ints(dfbs);
-    Eigen::LLT<Matrix> V_LLt(V);
-    Matrix I = Matrix::Identity(ndf, ndf);
-    auto L = V_LLt.matrixL();
-    Matrix V_L = L;
-    Matrix Linv_t = L.solve(I).transpose();
-    // check
-    //  std::cout << "||V - L L^t|| = " << (V - V_L * V_L.transpose()).norm() <<
-    //  std::endl;
-    //  std::cout << "||I - L L^-1|| = " << (I - V_L *
-    //  Linv_t.transpose()).norm() << std::endl;
-    //  std::cout << "||V^-1 - L^-1^t L^-1|| = " << (V.inverse() - Linv_t *
-    //  Linv_t.transpose()).norm() << std::endl;
-
-    Tensor2d K{ndf, ndf};
-    std::copy(Linv_t.data(), Linv_t.data() + ndf * ndf, K.begin());
-
-    xyK = Tensor3d{n, n, ndf};
-    btas::contract(1.0, Zxy, {1, 2, 3}, K, {1, 4}, 0.0, xyK, {2, 3, 4});
-    Zxy = Tensor3d{0, 0, 0};  // release memory
-
-    timers[0].stop(2);
-    std::cout << "time for integrals metric tform = " << timers[0].read(2)
-              << std::endl;
-  }  // if (xyK.size() == 0)
-
-  // compute exchange
-  timers[0].start(3);
-
-  const auto nocc = Cocc.cols();
-  Tensor2d Co{n, nocc};
-  std::copy(Cocc.data(), Cocc.data() + n * nocc, Co.begin());
-  Tensor3d xiK{n, nocc, ndf};
-  btas::contract(1.0, xyK, {1, 2, 3}, Co, {2, 4}, 0.0, xiK, {1, 4, 3});
-
-  Tensor2d G{n, n};
-  btas::contract(1.0, xiK, {1, 2, 3}, xiK, {4, 2, 3}, 0.0, G, {1, 4});
-
-  timers[0].stop(3);
-  std::cout << "time for exchange = " << timers[0].read(3) << std::endl;
-
-  // compute Coulomb
-  timers[0].start(4);
-
-  Tensor1d Jtmp{ndf};
-  btas::contract(1.0, xiK, {1, 2, 3}, Co, {1, 2}, 0.0, Jtmp, {3});
-  xiK = Tensor3d{0, 0, 0};
-  btas::contract(2.0, xyK, {1, 2, 3}, Jtmp, {3}, -1.0, G, {1, 2});
-
-  timers[0].stop(4);
-  std::cout << "time for coulomb = " << timers[0].read(4) << std::endl;
-
-  // copy result to an Eigen::Matrix
-  Matrix result(n, n);
-  std::copy(G.cbegin(), G.cend(), result.data());
-  return result;
-}
-#endif  // HAVE_DENSITY_FITTING
-
 // should be a unit test somewhere
 void api_basic_compile_test(const BasisSet& obs,
                             const std::vector<Atom>& atoms) {
@@ -0,0 +1,327 @@
+/*
+ *  Copyright (C) 2004-2017 Edward F. Valeev
+ *
+ *  This file is part of Libint.
+ *
+ *  Libint is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libint is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libint.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// the integral and Fock matrix builders of hartree-fock++, shared with the SCF
+// benchmark (tests/bench/scf-bench.cc); the non-template builders are defined
+// in hartree-fock++-builders.cc, which is compiled into both programs.
+
+#ifndef _libint2_tests_hartreefock_hartreefock_h_
+#define _libint2_tests_hartreefock_hartreefock_h_
+
+// standard C++ headers
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Eigen matrix algebra library
+#include <Eigen/Cholesky>
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+// have BTAS library?
+#ifdef LIBINT2_HAVE_BTAS
+#include <btas/btas.h>
+#endif  // LIBINT2_HAVE_BTAS
+
+// Libint Gaussian integrals library
+#include <libint2/engine_pool.h>
+#include <libint2.hpp>
+#include <libint2/symmetry.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+/// to use precomputed shell pair data must decide on max precision a priori
+const auto max_engine_precision = std::numeric_limits<double>::epsilon() / 1e10;
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    Matrix;  // import dense, dynamically sized Matrix type from Eigen;
+             // this is a matrix with row-major storage
+             // (http://en.wikipedia.org/wiki/Row-major_order)
+// to meet the layout of the integrals returned by the Libint integral library
+typedef Eigen::DiagonalMatrix<double, Eigen::Dynamic, Eigen::Dynamic>
+    DiagonalMatrix;
+
+using libint2::Shell;
+using libint2::Atom;
+using libint2::BasisSet;
+using libint2::Operator;
+using libint2::BraKet;
+
+// computes norm of shell-blocks of A
+Matrix compute_shellblock_norm(const BasisSet& obs, const Matrix& A);
+
+template <Operator obtype, typename OperatorParams = typename libint2::operator_traits<obtype>::oper_params_type>
+std::array<Matrix, libint2::operator_traits<obtype>::nopers> compute_1body_ints(
+    const BasisSet& obs,
+    OperatorParams oparams =
+        OperatorParams());
+
+template <libint2::Operator Kernel = libint2::Operator::coulomb>
+Matrix compute_schwarz_ints(
+    const BasisSet& bs1, const BasisSet& bs2 = BasisSet(),
+    bool use_2norm = false,  // use infty norm by default
+    typename libint2::operator_traits<Kernel>::oper_params_type params =
+        libint2::operator_traits<Kernel>::default_params());
+
+using shellpair_list_t = std::unordered_map<size_t, std::vector<size_t>>;
+extern shellpair_list_t obs_shellpair_list;  // shellpair list for OBS
+using shellpair_data_t = std::vector<std::vector<std::shared_ptr<libint2::ShellPair>>>;  // in same order as shellpair_list_t
+extern shellpair_data_t obs_shellpair_data;  // shellpair data for OBS
+
+/// computes non-negligible shell pair list; shells \c i and \c j form a
+/// non-negligible
+/// pair if they share a center or the Frobenius norm of their overlap is
+/// greater than threshold
+std::tuple<shellpair_list_t,shellpair_data_t>
+compute_shellpairs(const BasisSet& bs1,
+                   const BasisSet& bs2 = BasisSet(),
+                   double threshold = 1e-12);
+
+Matrix compute_2body_fock(
+    const BasisSet& obs, const Matrix& D,
+    double precision = std::numeric_limits<
+        double>::epsilon(),  // discard contributions smaller than this
+    const Matrix& Schwarz = Matrix(),  // K_ij = sqrt(||(ij|ij)||_\infty); if
+                                       // empty, do not Schwarz screen
+    const libint2::symmetry::PetiteList* petite_list =
+        nullptr  // if given, compute only the symmetry-unique shell quartets;
+                 // D must be totally symmetric
+    );
+
+#if LIBINT2_DERIV_ERI_ORDER
+// computes the 2-body contribution to the energy gradient, dE/dx =
+// \sum (2 D(a,b) D(c,d) - D(a,c) D(b,d)) d(ab|cd)/dx / 2, by contracting each
+// derivative shell set with the densities as soon as it is computed; returns
+// the natoms x 3 matrix of gradients
+Matrix compute_2body_gradient(
+    const BasisSet& obs, const std::vector<Atom>& atoms,
+    const Matrix& D,
+    double precision = std::numeric_limits<
+        double>::epsilon(),  // discard contributions smaller than this
+    const Matrix& Schwarz = Matrix()  // K_ij = sqrt(||(ij|ij)||_\infty); if
+                                       // empty, do not Schwarz screen
+    );
+#endif  // LIBINT2_DERIV_ERI_ORDER
+
+#ifdef LIBINT2_HAVE_BTAS
+#define HAVE_DENSITY_FITTING 1
+struct DFFockEngine {
+  const BasisSet& obs;
+  const BasisSet& dfbs;
+  DFFockEngine(const BasisSet& _obs, const BasisSet& _dfbs)
+      : obs(_obs), dfbs(_dfbs) {}
+
+  typedef btas::RangeNd<CblasRowMajor, std::array<long, 3>> Range3d;
+  typedef btas::Tensor<double, Range3d> Tensor3d;
+  Tensor3d xyK;
+
+  // a DF-based builder, using coefficients of occupied MOs
+  Matrix compute_2body_fock_dfC(const Matrix& Cocc);
+};
+#endif  // HAVE_DENSITY_FITTING
+
+namespace libint2 {
+extern int nthreads;
+
+/// fires off \c nthreads instances of lambda in parallel; an exception thrown
+/// by an instance (e.g. Engine::lmax_exceeded by an engine that EnginePool::get
+/// constructs in the thread) is rethrown on the calling thread after all
+/// instances have finished
+template <typename Lambda>
+void parallel_do(Lambda& lambda) {
+  std::vector<std::exception_ptr> exceptions(nthreads);
+  auto guarded_lambda = [&](int thread_id) {
+    try {
+      lambda(thread_id);
+    } catch (...) {
+      exceptions[thread_id] = std::current_exception();
+    }
+  };
+#ifdef _OPENMP
+#pragma omp parallel
+  {
+    auto thread_id = omp_get_thread_num();
+    guarded_lambda(thread_id);
+  }
+#else  // use C++11 threads
+  std::vector<std::thread> threads;
+  for (int thread_id = 0; thread_id != libint2::nthreads; ++thread_id) {
+    if (thread_id != nthreads - 1)
+      threads.push_back(std::thread(guarded_lambda, thread_id));
+    else
+      guarded_lambda(thread_id);
+  }  // threads_id
+  for (int thread_id = 0; thread_id < nthreads - 1; ++thread_id)
+    threads[thread_id].join();
+#endif
+  for (const auto& e : exceptions)
+    if (e) std::rethrow_exception(e);
+}
+}
+
+/// the engines of all threads, reused by all integral computations; the pool
+/// is rebuilt when libint2::nthreads changes
+libint2::EnginePool& engine_pool();
+
+/// if set, the Fock and gradient builders report the wall time of each of
+/// their phases (e.g. "fock" and "reduction", the accumulation of the
+/// contributions of the threads) in seconds by calling it
+extern std::function<void(const char* phase, double seconds)> report_phase;
+
+template <Operator obtype, typename OperatorParams>
+std::array<Matrix, libint2::operator_traits<obtype>::nopers> compute_1body_ints(
+    const BasisSet& obs, OperatorParams oparams) {
+  const auto n = obs.nbf();
+  const auto nshells = obs.size();
+  using libint2::nthreads;
+  typedef std::array<Matrix, libint2::operator_traits<obtype>::nopers>
+      result_type;
+  const unsigned int nopers = libint2::operator_traits<obtype>::nopers;
+  result_type result;
+  for (auto& r : result) r = Matrix::Zero(n, n);
+
+  auto shell2bf = obs.shell2bf();
+
+  auto compute = [&](int thread_id) {
+
+    // get the 1-body integrals engine of this thread
+    auto& engine =
+        engine_pool().get(thread_id, obtype, obs.max_nprim(), obs.max_l(), 0);
+    // pass operator params to the engine, e.g.
+    // nuclear attraction ints engine needs to know where the charges sit ...
+    // the nuclei are charges in this case; in QM/MM there will also be
+    // classical charges
+    engine.set_params(oparams);
+    std::array<double*, nopers> blk_ptrs;
+
+    // loop over unique shell pairs, {s1,s2} such that s1 >= s2
+    // this is due to the permutational symmetry of the real integrals over
+    // Hermitian operators: (1|2) = (2|1)
+    for (auto s1 = 0l; s1 != nshells; ++s1) {
+      auto bf1 = shell2bf[s1];  // first basis function in this shell
+      auto n1 = obs[s1].size();
+
+      auto s1_offset = s1 * (s1+1) / 2;
+      for (auto s2: obs_shellpair_list[s1]) {
+        auto s12 = s1_offset + s2;
+        if (s12 % nthreads != thread_id) continue;
+
+        auto bf2 = shell2bf[s2];
+        auto n2 = obs[s2].size();
+
+        // compute shell pair and copy it to the {s1,s2} blocks of the result
+        for (unsigned int op = 0; op != nopers; ++op)
+          blk_ptrs[op] = result[op].data() + bf1 * n + bf2;
+        engine.compute_and_copy(blk_ptrs.data(), {{size_t(n), 1, 0, 0}}, 1.0,
+                                false, obs[s1], obs[s2]);
+
+        if (s1 != s2)  // if s1 >= s2, copy {s1,s2} to the corresponding
+                       // {s2,s1} block, note the transpose!
+          for (unsigned int op = 0; op != nopers; ++op)
+            result[op].block(bf2, bf1, n2, n1) =
+                result[op].block(bf1, bf2, n1, n2).transpose();
+      }
+    }
+  };  // compute lambda
+
+  libint2::parallel_do(compute);
+
+  return result;
+}
+
+template <libint2::Operator Kernel>
+Matrix compute_schwarz_ints(
+    const BasisSet& bs1, const BasisSet& _bs2, bool use_2norm,
+    typename libint2::operator_traits<Kernel>::oper_params_type params) {
+  const BasisSet& bs2 = (_bs2.empty() ? bs1 : _bs2);
+  const auto nsh1 = bs1.size();
+  const auto nsh2 = bs2.size();
+  const auto bs1_equiv_bs2 = (&bs1 == &bs2);
+
+  Matrix K = Matrix::Zero(nsh1, nsh2);
+
+  using libint2::nthreads;
+
+  // !!! very important: cannot screen primitives in Schwarz computation !!!
+  auto epsilon = 0.;
+
+  std::cout << "computing Schwarz bound prerequisites (kernel=" << (int)Kernel
+            << ") ... ";
+
+  libint2::Timers<1> timer;
+  timer.set_now_overhead(25);
+  timer.start(0);
+
+  auto compute = [&](int thread_id) {
+
+    // get the 2-electron repulsion integrals engine of this thread
+    auto& engine = engine_pool().get(
+        thread_id, Kernel, std::max(bs1.max_nprim(), bs2.max_nprim()),
+        std::max(bs1.max_l(), bs2.max_l()), 0, epsilon);
+    engine.set_params(params);
+    const auto& buf = engine.results();
+
+    // loop over permutationally-unique set of shells
+    for (auto s1 = 0l, s12 = 0l; s1 != nsh1; ++s1) {
+      auto n1 = bs1[s1].size();  // number of basis functions in this shell
+
+      auto s2_max = bs1_equiv_bs2 ? s1 : nsh2 - 1;
+      for (auto s2 = 0; s2 <= s2_max; ++s2, ++s12) {
+        if (s12 % nthreads != thread_id) continue;
+
+        auto n2 = bs2[s2].size();
+        auto n12 = n1 * n2;
+
+        engine.compute2<Kernel, BraKet::xx_xx, 0>(bs1[s1], bs2[s2],
+                                                              bs1[s1], bs2[s2]);
+        assert(buf[0] != nullptr &&
+               "to compute Schwarz ints turn off primitive screening");
+
+        // to apply Schwarz inequality to individual integrals must use the diagonal elements
+        // to apply it to sets of functions (e.g. shells) use the whole shell-set of ints here
+        Eigen::Map<const Matrix> buf_mat(buf[0], n12, n12);
+        auto norm2 = use_2norm ? buf_mat.norm()
+                               : buf_mat.lpNorm<Eigen::Infinity>();
+        K(s1, s2) = std::sqrt(norm2);
+        if (bs1_equiv_bs2) K(s2, s1) = K(s1, s2);
+      }
+    }
+  };  // thread lambda
+
+  libint2::parallel_do(compute);
+
+  timer.stop(0);
+  std::cout << "done (" << timer.read(0) << " s)" << std::endl;
+
+  return K;
+}
+
+#endif  // header guard